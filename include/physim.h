@@ -20,13 +20,25 @@
 #ifndef INCLUDE_PHYSIM_H_
 #define INCLUDE_PHYSIM_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <map>
+#include <new>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <physim/mask.h>
+#include <physim/pool.h>
+#include <physim/shared.h>
+#include <physim/trace.h>
 #include <physim/type.h>
 
 namespace physim {
@@ -34,11 +46,16 @@ namespace physim {
 using namespace std;
 
 class AbstractPort;
+class Compiled;
 class ComposedModel;
 class Model;
 class Simulation;
 template <class T, int N> class InputPort;
 template <class T, int N> class OutputPort;
+template <class M> class MessageInputPort;
+template <class M> class MessageOutputPort;
+template <class S> class BusInputPort;
+template <class S> class BusOutputPort;
 
 class Monitor {
 public:
@@ -67,28 +84,33 @@ public:
 
 
 class AbstractValue {
+	friend class Simulation;
 public:
-	AbstractValue(Model *_parent, string name, Type& type, int size, flavor_t flavor);
+	AbstractValue(Model *_parent, string name, const Type& type, int size, flavor_t flavor);
 	virtual ~AbstractValue();
 	virtual bool parse(string text);
 	virtual void print(ostream& out);
 	virtual bool read(istream& in);
 	virtual void write(ostream& out);
 	virtual void init();
+	virtual unsigned long long hash(unsigned long long h);
+	virtual void snapshot(string& s);
 
 	inline Model *parent() const { return _parent; }
 	inline string name() const { return _name; }
-	inline Type& type() const { return _type; }
+	inline const Type& type() const { return _type; }
 	inline flavor_t flavor() const { return _flavor; }
 	inline int size() const { return _size; }
+	inline int id() const { return _id; }
 	string fullname();
 
 private:
 	Model *_parent;
 	string _name;
-	Type& _type;
+	const Type& _type;
 	flavor_t _flavor;
 	int _size;
+	int _id;
 	mutable string _full_name;
 };
 
@@ -108,6 +130,7 @@ public:
 	inline bool isSimulating() const;
 	inline const vector<AbstractPort *>& ports() const { return _ports; }
 	inline ComposedModel *parent() const { return _parent; }
+	inline int id() const { return _id; }
 
 	virtual bool isComposed() const { return false; }
 	virtual void init();
@@ -127,6 +150,7 @@ protected:
 	virtual void start();
 	virtual void stop();
 	virtual void finalize(Simulation& sim);
+	virtual void fastForward(date_t from, duration_t cycle, date_t count);
 
 private:
 	void add(AbstractValue *val);
@@ -136,6 +160,12 @@ private:
 	vector<AbstractPort *> _ports;
 	vector<AbstractValue *> _vals;
 	mutable string _full_name;
+	Model *_prev, *_next;
+	bool _pending, _retired, _staging;
+	int _scheds, _id, _inputs;
+	Mask _waiting;
+	AbstractPool *_pool;
+	vector<AbstractPort *> _staged;
 };
 
 class ReactiveModel: public Model {
@@ -147,23 +177,30 @@ protected:
 
 class PeriodicModel: public Model {
 	friend class Simulation;
+	friend class Compiled;
 public:
 	PeriodicModel(string name, duration_t period = 1, ComposedModel *parent = nullptr);
 	PeriodicModel(string name, ComposedModel *parent = nullptr);
 	inline duration_t period() const { return _period; }
+	inline bool isParked() const { return _parked; }
 protected:
 	void start() override;
 	void propagate(const AbstractPort& port) override;
 	void update();
 	virtual void update(date_t date) = 0;
 	void publish() override;
+	inline void steady() { _steady = true; }
 private:
 	duration_t _period;
+	date_t _phase;
+	bool _steady, _parked;
 };
 
 class AbstractPort {
 	friend class Model;
 	friend class ComposedModel;
+	friend class Simulation;
+	template <class T, int N> friend class InputPort;
 public:
 	AbstractPort(Model *model, string name, mode_t mode, const Type& type, int size);
 	virtual ~AbstractPort();
@@ -172,14 +209,33 @@ public:
 	inline const Type& type() const { return _type; }
 	inline int size() const { return _size; }
 	inline Model& model() const { return _model; }
+	inline int id() const { return _id; }
 	inline bool isLinked() const { return _back != nullptr; }
+	inline bool isFirstPending() const { return _model._waiting.only(_rank); }
 	AbstractPort *source();
 	string fullname() const;
 	virtual void publish();
 	virtual bool supportsReal();
 	virtual long double asReal(int i = 0);
+	virtual int gather(double *x, int i = 0, int n = -1);
+	virtual int gather(float *x, int i = 0, int n = -1);
+	static int gather(const vector<AbstractPort *>& ports, double *x);
+	static int gather(const vector<AbstractPort *>& ports, float *x);
+	virtual bool isConsumed() const;
+	virtual unsigned long long hash(unsigned long long h);
+	virtual void snapshot(string& s);
+	virtual size_t itemSize() const;
+	virtual size_t pack(char *base, size_t offset);
+	virtual void unpack();
 protected:
 	virtual void finalize(Monitor& mon);
+	virtual void unlink();
+	virtual void commit();
+	void watched(action_t action);
+	void reconnected(const AbstractPort& source);
+	inline bool staging() const { return _model._staging; }
+	inline bool wake() { return _model._waiting.add(_rank); }
+	inline void stage() { _model._staged.push_back(this); }
 private:
 	string _name;
 	mode_t _mode;
@@ -187,6 +243,8 @@ private:
 	int _size;
 	Model& _model;
 	AbstractPort *_back;
+	int _id;
+	int _rank;
 	mutable string _full_name;
 };
 
@@ -199,12 +257,37 @@ public:
 	inline operator const T&() const { return t[0]; }
 	inline const T& operator*() const { return t[0]; }
 	inline const T& operator[](int i) const { return t[i]; }
+	inline const T *data() const { return t; }
+	inline const T *begin() const { return t; }
+	inline const T *end() const { return t + N; }
+
+	static const size_t alignment = N > 1 && cache_line > alignof(T) ? cache_line : alignof(T);
 
 	bool supportsReal() override { return supports_real<T>(); }
 	long double asReal(int i = 0) override { return as_real(t[i]); }
+	int gather(double *x, int i = 0, int n = -1) override { return gathered(x, i, n); }
+	int gather(float *x, int i = 0, int n = -1) override { return gathered(x, i, n); }
+	unsigned long long hash(unsigned long long h) override
+		{ if(t != nullptr) for(int i = 0; i < N; i++) h = hash_value(t[i], h); return h; }
+	void snapshot(string& s) override
+		{ if(t != nullptr) for(int i = 0; i < N; i++) snapshot_value(t[i], s); }
+	size_t itemSize() const override { return sizeof(T); }
 
 protected:
 	T *t;
+
+private:
+	template <class R>
+	inline int gathered(R *x, int i, int n) {
+		if(n < 0 || i + n > N)
+			n = N - i;
+		if(t != nullptr)
+			as_reals(t + i, x, n);
+		else
+			for(int k = 0; k < n; k++)
+				x[k] = R();
+		return n;
+	}
 };
 
 template <class T, int N = 1>
@@ -213,17 +296,26 @@ class OutputPort: public Port<T, N> {
 	friend class InputPort<T, N>;
 public:
 	OutputPort(Model *parent, string name)
-		: Port<T, N>(parent, name, OUT), buf(new T[N]), _updated(false) { Port<T, N>::t = buf; }
+		: Port<T, N>(parent, name, OUT), buf(allocate()), _updated(false),
+		  _packed(false), _batch(0), _pending(false), _staged(false), _all(false), _behind(false),
+		  _wid(0), _firing(false)
+		{ Port<T, N>::t = buf; }
 	OutputPort(ComposedModel *parent, string name)
-		: Port<T, N>(parent, name, OUT), buf(nullptr), _updated(false) { }
+		: Port<T, N>(parent, name, OUT), buf(nullptr), _updated(false),
+		  _packed(false), _batch(0), _pending(false), _staged(false), _all(false), _behind(false),
+		  _wid(0), _firing(false) { }
 	OutputPort(PeriodicModel *parent, string name)
-		: Port<T, N>(parent, name, OUT), buf(new T[N]), _updated(true) { Port<T, N>::t = new T[N]; }
+		: Port<T, N>(parent, name, OUT), buf(allocate()), _updated(true),
+		  _packed(false), _batch(0), _pending(false), _staged(false), _all(true), _behind(false),
+		  _marked(N), _wid(0), _firing(false)
+		{ Port<T, N>::t = allocate(); }
 	~OutputPort() {
-		if(!Port<T, N>::isLinked()) {
+		if(_packed)
+			release();
+		else if(!Port<T, N>::isLinked()) {
 			if(buf != Port<T, N>::t)
-				delete [] Port<T, N>::t;
-			if(buf != nullptr)
-				delete [] buf;
+				dispose(Port<T, N>::t);
+			dispose(buf);
 		}
 	}
 
@@ -238,75 +330,617 @@ public:
 		int i;
 	};
 
+	class Observer {
+	public:
+		virtual ~Observer() { }
+		virtual void observe(const T *x) = 0;
+	};
+
+	inline void observe(Observer& o) { getBuffer(); _observers.push_back(&o); }
+	inline void unobserve(Observer& o)
+		{ _observers.erase(std::remove(_observers.begin(), _observers.end(), &o), _observers.end()); }
+
+	inline operator const T&() const { sync(); return Port<T, N>::t[0]; }
+	inline const T *data() const { sync(); return Port<T, N>::t; }
+	inline const T *begin() const { sync(); return Port<T, N>::t; }
+	inline const T *end() const { sync(); return Port<T, N>::t + N; }
+
 	inline OutputPort<T, N>& operator=(const T& x) { set(0, x); return *this; }
+	inline OutputPort<T, N>& operator=(T&& x) { set(0, std::move(x)); return *this; }
 	inline Accessor operator*() { return Accessor(*this, 0); }
 	inline Accessor operator[](int i) { return Accessor(*this, i); }
 
+	class Span {
+	public:
+		inline Span(OutputPort<T, N>& port): p(&port) { p->opened(); }
+		inline Span(Span&& s): p(s.p) { s.p = nullptr; }
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+		inline ~Span() { if(p != nullptr) p->touched(); }
+		inline T *data() const { return p->Port<T, N>::t; }
+		inline T& operator[](int i) const { return data()[i]; }
+		inline T *begin() const { return data(); }
+		inline T *end() const { return data() + N; }
+		inline int size() const { return N; }
+	private:
+		OutputPort<T, N> *p;
+	};
+
+	inline Span span() { return Span(*this); }
+
+	class Batch {
+	public:
+		inline Batch(OutputPort<T, N>& port): p(port) { p._batch++; }
+		inline ~Batch() { if(--p._batch == 0 && p._pending) { p._pending = false; p.changed(); } }
+	private:
+		OutputPort<T, N>& p;
+	};
+
+	void assign(const T *x, int n = N, int i = 0) {
+		if(n > N - i)
+			n = N - i;
+		if(_filter || !_watches.empty() || Port<T, N>::model().sim().tracing()) {
+			Batch b(*this);
+			for(int k = 0; k < n; k++)
+				set(i + k, x[k]);
+			return;
+		}
+		auto t = Port<T, N>::t + i;
+		if(_behind && n == N) {
+			_behind = false;
+			bool modified = false;
+			for(int k = 0; k < N; k++) {
+				if(x[k] != buf[k])
+					modified = true;
+				t[k] = x[k];
+			}
+			if(modified) {
+				_all = true;
+				_updated = true;
+			}
+			return;
+		}
+		sync();
+		open(i, n);
+		bool modified = false;
+		for(int k = 0; k < n; k++)
+			if(t[k] != x[k]) {
+				t[k] = x[k];
+				modified = true;
+				if(isDelayed())
+					mark(i + k);
+			}
+		if(modified) {
+			if(isDelayed())
+				_updated = true;
+			else
+				changed();
+		}
+	}
+	inline void assign(const T (&x)[N]) { assign(x, N); }
+	inline void assign(const std::initializer_list<T>& l) { assign(l.begin(), l.size()); }
+	inline void assign(const vector<T>& v, int i = 0) { assign(v.data(), v.size(), i); }
+
+	typedef std::function<bool(const T& old, const T& x)> predicate_t;
+	typedef std::function<void(date_t date, const T& x)> callback_t;
+
+	int watch(const predicate_t& pred, action_t action = STOP, int i = 0)
+		{ return watch(pred, [this, action](date_t, const T&) { AbstractPort::watched(action); }, i); }
+	int watch(const predicate_t& pred, const callback_t& fun, int i = 0)
+		{ _watches.push_back(Watch{_wid, i, pred, fun}); return _wid++; }
+	typedef std::function<bool(const T& old, T& x)> filter_t;
+
+	inline void setFilter(const filter_t& filter) { _filter = filter; }
+	void setDeadband(const T& abs, const T& rel = T()) {
+		_filter = [abs, rel](const T& o, T& x) {
+			auto d = x < o ? o - x : x - o;
+			return abs < d && rel * (o < T() ? -o : o) < d;
+		};
+	}
+	void setQuantum(const T& q) {
+		_filter = [q](const T& o, T& x) {
+			x = T(std::round(static_cast<long double>(x) / q) * q);
+			return true;
+		};
+	}
+
+	void unwatch(int id) {
+		for(auto& w: _watches)
+			if(w.id == id)
+				w.id = -1;
+		if(!_firing)
+			purge();
+	}
+
 	void publish() override {
 		if(_updated) {
-			for(int i = 0; i < N; i++)
-				buf[i] = Port<T, N>::t[i];
+			rebind(buf, Port<T, N>::t);
+			if(_all)
+				_behind = true;
+			else
+				for(auto i: _dirty)
+					Port<T, N>::t[i] = buf[i];
+			for(auto i: _dirty)
+				_marked[i] = false;
+			_dirty.clear();
+			_all = false;
 			propagate();
 			_updated = false;
 		}
 	}
 	inline void propagate();
+	inline void changed() {
+		if(_staged)
+			return;
+		if(_batch != 0)
+			_pending = true;
+		else
+			propagate();
+	}
+	void commit() override {
+		_staged = false;
+		bool modified = false;
+		for(size_t k = 0; k < _written.size(); k++) {
+			auto i = _written[k];
+			_logged[i] = false;
+			if(Port<T, N>::t[i] != _before[k]) {
+				modified = true;
+				if(!_watches.empty())
+					check(i, _before[k]);
+			}
+		}
+		_written.clear();
+		_before.clear();
+		if(modified)
+			propagate();
+	}
+	bool isConsumed() const override { return !_links.empty() || !_observers.empty(); }
+	long double asReal(int i = 0) override { sync(); return Port<T, N>::asReal(i); }
+	int gather(double *x, int i = 0, int n = -1) override { sync(); return Port<T, N>::gather(x, i, n); }
+	int gather(float *x, int i = 0, int n = -1) override { sync(); return Port<T, N>::gather(x, i, n); }
+	unsigned long long hash(unsigned long long h) override {
+		sync();
+		h = Port<T, N>::hash(h);
+		if(buf != nullptr && isDelayed())
+			for(int i = 0; i < N; i++) h = hash_value(buf[i], h);
+		return h;
+	}
+	void snapshot(string& s) override {
+		sync();
+		Port<T, N>::snapshot(s);
+		if(buf != nullptr && isDelayed())
+			for(int i = 0; i < N; i++) snapshot_value(buf[i], s);
+	}
+
+	size_t pack(char *base, size_t offset) override {
+		if(buf == nullptr || _packed || Port<T, N>::isLinked())
+			return offset;
+		sync();
+		const size_t a = Port<T, N>::alignment, s = (N * sizeof(T) + a - 1) / a * a;
+		offset = (offset + a - 1) / a * a;
+		auto d = isDelayed();
+		if(base != nullptr) {
+			auto t = reinterpret_cast<T *>(base + offset);
+			auto b = d ? reinterpret_cast<T *>(base + offset + s) : t;
+			for(int i = 0; i < N; i++)
+				new(t + i) T(Port<T, N>::t[i]);
+			if(d)
+				for(int i = 0; i < N; i++)
+					new(b + i) T(buf[i]);
+			if(d)
+				dispose(Port<T, N>::t);
+			dispose(buf);
+			rebind(t, b);
+			_packed = true;
+		}
+		return offset + (d ? s + N * sizeof(T) : N * sizeof(T));
+	}
+
+	void unpack() override {
+		if(_packed) {
+			sync();
+			auto d = isDelayed();
+			auto t = allocate();
+			for(int i = 0; i < N; i++)
+				t[i] = Port<T, N>::t[i];
+			auto b = t;
+			if(d) {
+				b = allocate();
+				for(int i = 0; i < N; i++)
+					b[i] = buf[i];
+			}
+			release();
+			rebind(t, b);
+			_packed = false;
+		}
+	}
 
 private:
 	inline bool isDelayed() const { return buf != Port<T, N>::t; }
-	inline T *getBuffer() { if(buf == nullptr) Port<T, N>::t = buf = new T[N]; return buf; }
-	inline const T& get(int i) const { return Port<T, N>::t[i]; }
+	inline T *getBuffer() { if(buf == nullptr) Port<T, N>::t = buf = allocate(); return buf; }
+	typedef BufferPool<T, N, Port<T, N>::alignment> buffer_pool;
+	static inline T *allocate() { return buffer_pool::allocate(); }
+	static inline void dispose(T *p) { buffer_pool::release(p); }
+	inline const T& get(int i) const { sync(); return Port<T, N>::t[i]; }
+
+	inline void sync() const {
+		if(_behind) {
+			_behind = false;
+			for(int i = 0; i < N; i++)
+				Port<T, N>::t[i] = buf[i];
+		}
+	}
+
+	inline void mark(int i) {
+		if(!_all && !_marked[i]) {
+			_marked[i] = true;
+			_dirty.push_back(i);
+			if(_dirty.size() == N)
+				_all = true;
+		}
+	}
+
+	void rebind(T *t, T *b) {
+		Port<T, N>::t = t;
+		buf = b;
+		for(auto l: _links)
+			l->t = b;
+	}
+
+	void release() {
+		for(int i = 0; i < N; i++)
+			Port<T, N>::t[i].~T();
+		if(isDelayed())
+			for(int i = 0; i < N; i++)
+				buf[i].~T();
+	}
+
+	void opened() {
+		sync();
+		open(0, N);
+		if(_filter || !_watches.empty() || (!_staged && !isDelayed()))
+			_span.assign(Port<T, N>::t, Port<T, N>::t + N);
+	}
+
+	void touched() {
+		auto t = Port<T, N>::t;
+		if(_filter || !_watches.empty()) {
+			Batch b(*this);
+			for(int i = 0; i < N; i++) {
+				T x = t[i];
+				t[i] = _span[i];
+				set(i, x);
+			}
+			_span.clear();
+			return;
+		}
+		const T *o = isDelayed() ? buf : _span.data();
+		bool modified = false;
+		for(int i = 0; i < N; i++)
+			if(_staged || t[i] != o[i]) {
+				if(Port<T, N>::model().sim().tracing())
+					trace(i, t[i]);
+				if(isDelayed())
+					mark(i);
+				modified = true;
+			}
+		_span.clear();
+		if(!modified || _staged)
+			return;
+		if(isDelayed())
+			_updated = true;
+		else
+			changed();
+	}
 
 	inline void set(int i, const T& x) {
-		if(Port<T, N>::t[i] != x) {
-			Port<T, N>::t[i] = x;
-			if(Port<T, N>::model().sim().tracing()) {
-				Port<T, N>::model().err() << "TRACE: " << Port<T, N>::model().sim().date()
-					<< ": port " << Port<T, N>::fullname();
-				if(N != 1)
-					Port<T, N>::model().err() <<  "[" << i << "]";
-				Port<T, N>::model().err() << " receives " << x << endl;
+		sync();
+		if(_filter)
+			filter(i, x);
+		else if(Port<T, N>::t[i] != x)
+			change(i, x);
+	}
+
+	inline void set(int i, T&& x) {
+		sync();
+		if(_filter || !_watches.empty())
+			set(i, static_cast<const T&>(x));
+		else if(Port<T, N>::t[i] != x) {
+			open(i, 1);
+			Port<T, N>::t[i] = std::move(x);
+			written(i);
+		}
+	}
+
+	void filter(int i, T x) {
+		if(_filter(Port<T, N>::t[i], x) && Port<T, N>::t[i] != x)
+			change(i, x);
+	}
+
+	inline void change(int i, const T& x) {
+		if(!_watches.empty()) {
+			T o = Port<T, N>::t[i];
+			write(i, x);
+			if(!_staged)
+				check(i, o);
+		}
+		else
+			write(i, x);
+	}
+
+	inline void open(int i, int n) {
+		if(!_staged) {
+			if(isDelayed() || !AbstractPort::staging())
+				return;
+			_staged = true;
+			if(_logged.empty())
+				_logged.resize(N);
+			AbstractPort::stage();
+		}
+		for(int k = i; k < i + n; k++)
+			if(!_logged[k]) {
+				_logged[k] = true;
+				_written.push_back(k);
+				_before.push_back(Port<T, N>::t[k]);
 			}
-			if(isDelayed())
-				_updated = true;
-			else
-				propagate();
+	}
+
+	inline void write(int i, const T& x) {
+		open(i, 1);
+		Port<T, N>::t[i] = x;
+		written(i);
+	}
+
+	inline void written(int i) {
+		if(Port<T, N>::model().sim().tracing())
+			trace(i, Port<T, N>::t[i]);
+		if(isDelayed()) {
+			mark(i);
+			_updated = true;
 		}
+		else
+			changed();
 	}
 
+	void trace(int i, const T& x) {
+		auto r = Port<T, N>::model().sim().recorder();
+		if(r != nullptr) {
+			r->record(Port<T, N>::model().sim().date(), static_cast<AbstractPort *>(this), i, x);
+			return;
+		}
+		Port<T, N>::model().err() << "TRACE: " << Port<T, N>::model().sim().date()
+			<< ": port " << Port<T, N>::fullname();
+		if(N != 1)
+			Port<T, N>::model().err() <<  "[" << i << "]";
+		Port<T, N>::model().err() << " receives " << x << endl;
+	}
+
+	void check(int i, const T& o) {
+		auto firing = _firing;
+		_firing = true;
+		for(size_t k = 0; k < _watches.size(); k++)
+			if(_watches[k].id >= 0 && _watches[k].i == i && _watches[k].pred(o, Port<T, N>::t[i])) {
+				auto f = _watches[k].fun;
+				f(Port<T, N>::model().date(), Port<T, N>::t[i]);
+			}
+		_firing = firing;
+		if(!_firing)
+			purge();
+	}
+
+	inline void purge() {
+		_watches.erase(std::remove_if(_watches.begin(), _watches.end(),
+			[](const Watch& w) { return w.id < 0; }), _watches.end());
+	}
+
+	class Watch {
+	public:
+		int id, i;
+		predicate_t pred;
+		callback_t fun;
+	};
+
 	vector<InputPort<T, N> *> _links;
+	vector<Observer *> _observers;
 	T *buf;
-	bool _updated;
+	bool _updated, _packed;
+	int _batch;
+	bool _pending, _staged;
+	vector<int> _written;
+	vector<T> _before;
+	vector<bool> _logged;
+	vector<T> _span;
+	bool _all;
+	mutable bool _behind;
+	vector<int> _dirty;
+	vector<bool> _marked;
+	filter_t _filter;
+	vector<Watch> _watches;
+	int _wid;
+	bool _firing;
 };
 
+template <class T> inline std::function<bool(const T&, const T&)> above(const T& th)
+	{ return [th](const T& o, const T& x) { return th < x; }; }
+template <class T> inline std::function<bool(const T&, const T&)> below(const T& th)
+	{ return [th](const T& o, const T& x) { return x < th; }; }
+template <class T> inline std::function<bool(const T&, const T&)> rises_above(const T& th)
+	{ return [th](const T& o, const T& x) { return !(th < o) && th < x; }; }
+template <class T> inline std::function<bool(const T&, const T&)> falls_below(const T& th)
+	{ return [th](const T& o, const T& x) { return !(o < th) && x < th; }; }
+
 
 template <class T, int N = 1>
 class InputPort: public Port<T, N> {
+	friend class OutputPort<T, N>;
 public:
 	InputPort(Model *parent, string name)
-		: Port<T, N>(parent, name, IN), _needs_update(false) { }
-	inline void touch() { _needs_update = true; AbstractPort::model().propagate(*this); }
+		: Port<T, N>(parent, name, IN), _needs_update(false), _source(nullptr), _index(-1) { }
+	inline void touch() { _needs_update = true; if(AbstractPort::wake()) AbstractPort::model().propagate(*this); }
+
+	void reconnect(OutputPort<T, N>& op) {
+		unlink();
+		AbstractPort::_back = &op;
+		if(Port<T, N>::model().simEnabled()) {
+			link();
+			if(Port<T, N>::model().sim().tracing())
+				AbstractPort::reconnected(op);
+			if(_source != nullptr)
+				touch();
+		}
+	}
+
+protected:
+	void unlink() override {
+		if(_source != nullptr) {
+			auto& l = _source->_links;
+			l[_index] = l.back();
+			l[_index]->_index = _index;
+			l.pop_back();
+			_source = nullptr;
+			_index = -1;
+		}
+		Port<T, N>::t = nullptr;
+	}
 
 private:
 	void finalize(Monitor& mon) override {
-		auto p = Port<T, N>::source();
-		if(p == nullptr)
+		link();
+		if(_source == nullptr)
 			Port<T, N>::model().error("input port " + Port<T, N>::fullname() + " is dangling!");
-		else {
-			auto op = static_cast<OutputPort<T, N> *>(p);
-			Port<T, N>::t = op->getBuffer();
-			op->_links.push_back(this);
-			if(Port<T, N>::model().sim().tracing())
-				Port<T, N>::model().err() << Port<T, N>::fullname() << " connected to " << op->Port<T, N>::fullname() << endl;
+		else if(Port<T, N>::model().sim().textTracing())
+			Port<T, N>::model().err() << Port<T, N>::fullname() << " connected to " << _source->fullname() << endl;
+	}
+
+	void link() {
+		auto p = Port<T, N>::source();
+		if(p != nullptr) {
+			_source = static_cast<OutputPort<T, N> *>(p);
+			Port<T, N>::t = _source->getBuffer();
+			_index = _source->_links.size();
+			_source->_links.push_back(this);
 		}
 	}
 
 	bool _needs_update;
+	OutputPort<T, N> *_source;
+	int _index;
+};
+
+template <class M>
+class MessageOutputPort: public AbstractPort {
+	friend class MessageInputPort<M>;
+	class Envelope {
+	public:
+		template <class... A> inline Envelope(A&&... args): msg(std::forward<A>(args)...), refs(0) { }
+		M msg;
+		int refs;
+	};
+	typedef Pool<Envelope> pool_t;
+public:
+	MessageOutputPort(Model *parent, string name)
+		: AbstractPort(parent, name, OUT, type_of<M>(), 1) { }
+
+	template <class... A>
+	void send(A&&... args) {
+		if(_links.empty())
+			return;
+		auto e = new(pool_t::pool().allocate()) Envelope(std::forward<A>(args)...);
+		for(auto l: _links)
+			l->receive(e);
+	}
+	bool isConsumed() const override { return !_links.empty(); }
+	void publish() override { }
+
+private:
+	static inline void release(Envelope *e) {
+		if(--e->refs == 0) {
+			e->~Envelope();
+			pool_t::pool().release(e);
+		}
+	}
+	vector<MessageInputPort<M> *> _links;
+};
+
+template <class M>
+class MessageInputPort: public AbstractPort {
+	friend class MessageOutputPort<M>;
+	typedef typename MessageOutputPort<M>::Envelope Envelope;
+public:
+	MessageInputPort(Model *parent, string name)
+		: AbstractPort(parent, name, IN, type_of<M>(), 1), _source(nullptr), _staged(false) { }
+	~MessageInputPort() { drop(_msgs); drop(_next); }
+
+	class Iterator {
+	public:
+		inline Iterator(Envelope * const *p): _p(p) { }
+		inline const M& operator*() const { return (*_p)->msg; }
+		inline const M *operator->() const { return &(*_p)->msg; }
+		inline Iterator& operator++() { _p++; return *this; }
+		inline bool operator!=(const Iterator& i) const { return _p != i._p; }
+	private:
+		Envelope * const *_p;
+	};
+
+	inline int size() const { return _msgs.size(); }
+	inline bool empty() const { return _msgs.empty(); }
+	inline const M& operator[](int i) const { return _msgs[i]->msg; }
+	inline Iterator begin() const { return Iterator(_msgs.data()); }
+	inline Iterator end() const { return Iterator(_msgs.data() + _msgs.size()); }
+
+protected:
+	void unlink() override {
+		if(_source != nullptr) {
+			auto& l = _source->_links;
+			l.erase(std::find(l.begin(), l.end(), this));
+			_source = nullptr;
+		}
+		drop(_msgs);
+		drop(_next);
+	}
+
+	void commit() override {
+		_staged = false;
+		drop(_msgs);
+		_msgs.swap(_next);
+		if(!_msgs.empty()) {
+			_staged = true;
+			AbstractPort::stage();
+		}
+	}
+
+private:
+	void finalize(Monitor& mon) override;
+
+	void receive(Envelope *e) {
+		e->refs++;
+		if(AbstractPort::staging())
+			_next.push_back(e);
+		else
+			_msgs.push_back(e);
+		if(!_staged) {
+			_staged = true;
+			AbstractPort::stage();
+		}
+		if(AbstractPort::wake())
+			this->model().propagate(*this);
+	}
+
+	static void drop(vector<Envelope *>& msgs) {
+		for(auto e: msgs)
+			MessageOutputPort<M>::release(e);
+		msgs.clear();
+	}
+
+	MessageOutputPort<M> *_source;
+	vector<Envelope *> _msgs, _next;
+	bool _staged;
 };
 
 
 class ComposedModel: public Model {
 	friend class Model;
+	friend class Simulation;
 public:
 	ComposedModel(string name, ComposedModel *parent = nullptr);
 
@@ -318,6 +952,18 @@ public:
 		{ opt._back = &ops; }
 	template <class T, int N> void connect(OutputPort<T, N>& ops, InputPort<T, N>& ips)
 		{ ips._back = &ops; }
+	template <class M> void connect(MessageOutputPort<M>& op, MessageInputPort<M>& ip)
+		{ ip._back = &op; }
+	template <class M> void connect(MessageInputPort<M>& ips, MessageInputPort<M>& ipt)
+		{ ipt._back = &ips; }
+	template <class M> void connect(MessageOutputPort<M>& ops, MessageOutputPort<M>& opt)
+		{ opt._back = &ops; }
+	template <class S> void connect(BusOutputPort<S>& op, BusInputPort<S>& ip)
+		{ ip._back = &op; }
+	template <class S> void connect(BusInputPort<S>& ips, BusInputPort<S>& ipt)
+		{ ipt._back = &ips; }
+	template <class S> void connect(BusOutputPort<S>& ops, BusOutputPort<S>& opt)
+		{ opt._back = &ops; }
 
 	inline const vector<Model *>& subModels() const { return subs; }
 	bool isComposed() const override { return true; }
@@ -329,12 +975,16 @@ protected:
 	void stop() override;
 	void finalize(Simulation& sim) override;
 	void publish() override;
+	void fastForward(date_t from, duration_t cycle, date_t count) override;
 
 private:
 	vector<Model *> subs;
 };
 
 class Simulation {
+	friend class Compiled;
+	friend class ComposedModel;
+	friend class PeriodicModel;
 public:
 	Simulation(Model& top);
 	Simulation(Model& top, Monitor& mon);
@@ -346,22 +996,74 @@ public:
 	void step();
 	void pause();
 	void stop();
+	void halt(action_t action);
 	void trigger(Model& model);
 	void triggerLast(Model& model);
 	void schedule(Model& model, date_t at);
 	inline date_t date() const { return _date; }
 
+	template <class M, class... A>
+	M *create(A&&... args) {
+		auto& p = Pool<M>::pool();
+		auto m = new(p.allocate()) M(std::forward<A>(args)...);
+		m->_pool = &p;
+		return m;
+	}
+	void activate(Model& model);
+	void retire(Model& model);
+
 	inline Model& top() const { return _top; }
 	inline Monitor& monitor() const { return *_mon; }
-	inline bool tracing() const { return _tracing; }
+#	ifdef PHYSIM_NO_TRACE
+		inline bool tracing() const { return false; }
+#	else
+		inline bool tracing() const { return _tracing; }
+#	endif
+	inline bool textTracing() const { return tracing() && _rec == nullptr; }
 	inline void setTracing(bool t) { _tracing = t; }
 	inline bool isStopped() const { return _state == STOPPED; }
 	inline bool isRunning() const { return _state == STOPPED; }
 	inline bool isPaused() const { return _state == STOPPED; }
+	inline const vector<vector<Model *> >& chains() const { return _chains; }
+	inline bool fastForwarding() const { return _ff; }
+	inline void setFastForward(bool ff) { _ff = ff; }
+	inline date_t horizon() const { return _horizon; }
+	void setRecorder(TraceRecorder *rec);
+	inline TraceRecorder *recorder() const { return _rec; }
+
+	inline const vector<Model *>& models() const { return _models; }
+	inline const vector<AbstractPort *>& ports() const { return _ports; }
+	inline const vector<AbstractValue *>& values() const { return _values; }
+	inline Model *model(int id) const { return _models[id]; }
+	inline AbstractPort *port(int id) const { return _ports[id]; }
+	inline AbstractValue *value(int id) const { return _values[id]; }
+	Model *findModel(const string& path) const;
+	AbstractPort *findPort(const string& path) const;
+	AbstractValue *findValue(const string& path) const;
 
 private:
 
 	void advance();
+	void settle();
+	void update(Model& model);
+	void perform(Model& model);
+	void trace(TraceRecorder::kind_t kind, Model& model, date_t at = 0);
+	void record(Model& model);
+	void index(Model& model);
+	void unindex(Model& model);
+	void indexPaths() const;
+	void fuse();
+	void collect(Model& model, vector<Model *>& models);
+	void detach(Model& model);
+	int scheduled(Model& model);
+	void unschedule();
+	void release();
+	void pack();
+	void initValues(Model& model);
+	unsigned long long hash(Model& model, unsigned long long h);
+	void snapshot(Model& model, string& s);
+	void detect(date_t end);
+	void applyHalt();
 
 	typedef enum {
 		STOPPED,
@@ -385,16 +1087,58 @@ private:
 	set<Model *> _last;
 	priority_queue<Date> _sched;
 	vector<Model *> _pers;
+	vector<vector<Model *> > _chains;
+	vector<Model *> _dead;
+	Model *_current;
 	date_t _date;
 	Monitor *_mon;
-	bool _mon_alloc, _tracing;
+	bool _mon_alloc, _tracing, _ff;
+	duration_t _hyper;
+	date_t _horizon;
+	action_t _halt;
+	bool _halting;
+	map<unsigned long long, pair<date_t, string> > _hashes;
+	char *_arena;
+	TraceRecorder *_rec;
+	vector<Model *> _models;
+	vector<AbstractPort *> _ports;
+	vector<AbstractValue *> _values;
+	vector<int> _free_models, _free_ports, _free_values;
+	mutable unordered_map<string, int> _model_index, _port_index, _value_index;
+	mutable bool _indexed;
 	state_t _state;
 };
 
+class Compiled {
+public:
+	static inline void start(Simulation& sim) { sim.start(); sim.unschedule(); }
+	static inline void update(PeriodicModel& model, date_t date) { model.update(date); }
+	static inline void publish(Model& model) { model.publish(); }
+	static inline void settle(Simulation& sim) { sim.settle(); }
+};
+
 inline date_t Model::date() const { return sim().date(); }
 template <class T, int N>
-inline void OutputPort<T, N>::propagate()
-	{ for(auto p: _links) p->touch(); }
+inline void OutputPort<T, N>::propagate() {
+	for(auto p: _links)
+		p->touch();
+	for(auto o: _observers)
+		o->observe(buf);
+}
+template <class M>
+void MessageInputPort<M>::finalize(Monitor& mon) {
+	if(model().isComposed())
+		return;
+	auto p = source();
+	if(p == nullptr)
+		model().error("input port " + fullname() + " is dangling!");
+	else {
+		_source = static_cast<MessageOutputPort<M> *>(p);
+		_source->_links.push_back(this);
+		if(model().sim().textTracing())
+			model().err() << fullname() << " connected to " << _source->fullname() << endl;
+	}
+}
 bool Model::isSimulating() const { return _sim != nullptr && !_sim->isStopped(); }
 
 template <class T, int N>
@@ -425,12 +1169,12 @@ template <class T, int N>
 class State: public AbstractValue {
 public:
 	inline State(Model *parent, string name)
-		: AbstractValue(parent, name, type_of<T>(), N, PARAM) { }
+		: AbstractValue(parent, name, type_of<T>(), N, STATE) { }
 	inline State(Model *parent, string name, const T& x)
-		: AbstractValue(parent, name, type_of<T>(), N, PARAM)
+		: AbstractValue(parent, name, type_of<T>(), N, STATE)
 		{ for(int i = 0; i < N; i++) it[i] = x; }
 	inline State(Model *parent, string name, const initializer_list<T>& l)
-		: AbstractValue(parent, name, type_of<T>(), N, PARAM)
+		: AbstractValue(parent, name, type_of<T>(), N, STATE)
 		{ auto i = 0; for(const auto& x: l) { it[i] = x; i++; } }
 
 	inline operator const T&() const { return t[0]; }
@@ -442,6 +1186,10 @@ public:
 	inline T& operator[](int i) { return t[i]; }
 
 	virtual void init() { for(int i = 0; i < N; i++) t[i] = it[i]; }
+	unsigned long long hash(unsigned long long h) override
+		{ for(int i = 0; i < N; i++) h = hash_value(t[i], h); return h; }
+	void snapshot(string& s) override
+		{ for(int i = 0; i < N; i++) snapshot_value(t[i], s); }
 
 private:
 	T t[N], it[N];
@@ -454,6 +1202,8 @@ public:
 
 	int run(int argc = 1, char **argv = nullptr);
 	inline void setTracing(bool t) { _tracing = t; }
+	inline void setFastForward(bool ff) { _ff = ff; }
+	inline void setTraceFile(const string& path) { _trace = path; }
 
 protected:
 	virtual int perform() = 0;
@@ -464,7 +1214,8 @@ protected:
 
 private:
 	Simulation *_sim;
-	bool _tracing;
+	bool _tracing, _ff;
+	string _trace;
 };
 
 
@@ -477,9 +1228,14 @@ protected:
 	void dumpOptions() override;
 private:
 	duration_t _d;
+	string _dump, _compile;
 };
 
-#define PHYSIM_RUN(C) int main(int argc, char **argv) { return C().run(argc, argv); }
+#ifdef PHYSIM_COMPILED
+#	define PHYSIM_RUN(C)
+#else
+#	define PHYSIM_RUN(C) int main(int argc, char **argv) { return C().run(argc, argv); }
+#endif
 
 }	// physim
 
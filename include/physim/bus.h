@@ -0,0 +1,268 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_BUS_H_
+#define INCLUDE_PHYSIM_BUS_H_
+
+#include <physim.h>
+
+namespace physim {
+
+class AbstractBusPort;
+
+/**
+ * @class Bus
+ * Base class of signal buses: a bus is a structure of named signals
+ * (see Signal) exchanged as a whole between models through a
+ * BusOutputPort and BusInputPort pair. The signals are stored
+ * contiguously in the bus, the pair is connected in one call and
+ * the writes of the producer are propagated as a single event carrying
+ * the mask of changed signals.
+ * @code
+ * class Chassis: public Bus {
+ * public:
+ *		Signal<double> speed {this, "speed"};
+ *		Signal<int> gear {this, "gear", 1};
+ * };
+ * @endcode
+ * The changed signals are recorded in a Mask holding one bit per signal.
+ */
+class Bus {
+	template <class T> friend class Signal;
+	template <class S> friend class BusOutputPort;
+public:
+
+	/// Set of signals of a bus, one bit per signal index.
+	typedef physim::Mask Mask;
+
+	inline Bus(): _port(nullptr) { }
+	Bus(const Bus&) = delete;
+	Bus& operator=(const Bus&) = delete;
+	inline int size() const { return _signals.size(); }
+	inline const char *name(int i) const { return _signals[i].name; }
+	inline const Mask& changed() const { return _changed; }
+
+private:
+	typedef void (*copy_t)(void *dst, const void *src);
+	class Entry {
+	public:
+		const char *name;
+		size_t offset;
+		copy_t copy;
+	};
+
+	inline int add(const char *name, size_t offset, copy_t copy)
+		{ _signals.push_back(Entry{name, offset, copy}); return _signals.size() - 1; }
+	inline void touch(int i);
+	void copy(const Bus& bus, const Mask& mask) {
+		auto d = reinterpret_cast<char *>(this);
+		auto s = reinterpret_cast<const char *>(&bus);
+		for(int i = 0; i < size(); i++)
+			if(mask.contains(i))
+				_signals[i].copy(d + _signals[i].offset, s + _signals[i].offset);
+	}
+
+	AbstractBusPort *_port;
+	Mask _changed;
+	vector<Entry> _signals;
+};
+
+/**
+ * @class Signal
+ * Named signal of a bus. Assigning a different value marks the signal
+ * as changed and informs the port owning the bus.
+ * @param T	Type of the signal value.
+ */
+template <class T>
+class Signal {
+public:
+	Signal(Bus *bus, const char *name, const T& init = T())
+		: _v(init), _offset(reinterpret_cast<char *>(this) - reinterpret_cast<char *>(bus)),
+		  _index(bus->add(name, _offset, copy)) { }
+	Signal(const Signal<T>&) = delete;
+	Signal<T>& operator=(const Signal<T>&) = delete;
+	inline operator const T&() const { return _v; }
+	inline const T& operator*() const { return _v; }
+	inline int index() const { return _index; }
+	inline Signal<T>& operator=(const T& x)
+		{ if(_v != x) { _v = x; bus().touch(_index); } return *this; }
+private:
+	static void copy(void *d, const void *s)
+		{ static_cast<Signal<T> *>(d)->_v = static_cast<const Signal<T> *>(s)->_v; }
+	inline Bus& bus() { return *reinterpret_cast<Bus *>(reinterpret_cast<char *>(this) - _offset); }
+	T _v;
+	size_t _offset;
+	int _index;
+};
+
+class AbstractBusPort: public AbstractPort {
+	friend class Bus;
+public:
+	inline AbstractBusPort(Model *model, string name, mode_t mode, const Type& type)
+		: AbstractPort(model, name, mode, type, 1) { }
+protected:
+	virtual void written() = 0;
+};
+
+inline void Bus::touch(int i) {
+	_changed.add(i);
+	if(_port != nullptr)
+		_port->written();
+}
+
+/**
+ * @class BusOutputPort
+ * Output port providing a bus of type S. The signals are written with
+ * port->signal = value. The changed signals are propagated once at the
+ * end of the update of the model or, for periodic models, when the port
+ * is published (only the changed signals are copied to the published
+ * bus).
+ * @param S	Type of the bus (derived from Bus).
+ */
+template <class S>
+class BusOutputPort: public AbstractBusPort {
+	friend class BusInputPort<S>;
+public:
+	BusOutputPort(Model *parent, string name)
+		: AbstractBusPort(parent, name, OUT, type_of<S>()), _delayed(false), _staged(false), _updated(false)
+		{ _bus[0]._port = this; }
+	BusOutputPort(PeriodicModel *parent, string name)
+		: AbstractBusPort(parent, name, OUT, type_of<S>()), _delayed(true), _staged(false), _updated(false)
+		{ _bus[0]._port = this; }
+
+	inline S *operator->() { return &_bus[0]; }
+	inline S& operator*() { return _bus[0]; }
+	inline const S& published() const { return _bus[_delayed ? 1 : 0]; }
+	bool isConsumed() const override { return !_links.empty(); }
+
+	void publish() override {
+		if(_updated) {
+			_updated = false;
+			_bus[1].copy(_bus[0], _bus[0]._changed);
+			flush();
+		}
+	}
+
+protected:
+	void written() override {
+		if(_delayed)
+			_updated = true;
+		else if(!staging())
+			flush();
+		else if(!_staged) {
+			_staged = true;
+			stage();
+		}
+	}
+
+	void commit() override {
+		_staged = false;
+		flush();
+	}
+
+private:
+	void flush() {
+		for(auto l: _links)
+			l->receive(_bus[0]._changed);
+		_bus[0]._changed.clear();
+	}
+
+	S _bus[2];
+	bool _delayed, _staged, _updated;
+	vector<BusInputPort<S> *> _links;
+};
+
+/**
+ * @class BusInputPort
+ * Input port receiving a bus of type S. The signals are read with
+ * port->signal and changed() gives the signals changed since the last
+ * update of the model.
+ * @code
+ * if(x.changed(x->gear))
+ *		shift(x->gear);
+ * @endcode
+ * @param S	Type of the bus (derived from Bus).
+ */
+template <class S>
+class BusInputPort: public AbstractPort {
+	friend class BusOutputPort<S>;
+public:
+	BusInputPort(Model *parent, string name)
+		: AbstractPort(parent, name, IN, type_of<S>(), 1), _source(nullptr), _staged(false) { }
+	inline const S *operator->() const { return &_source->published(); }
+	inline const S& operator*() const { return _source->published(); }
+	inline const Bus::Mask& changed() const { return _changed; }
+	template <class T> inline bool changed(const Signal<T>& s) const
+		{ return _changed.contains(s.index()); }
+
+protected:
+	void unlink() override {
+		if(_source != nullptr) {
+			auto& l = _source->_links;
+			l.erase(std::find(l.begin(), l.end(), this));
+			_source = nullptr;
+		}
+	}
+
+	void commit() override {
+		_staged = false;
+		_changed.swap(_next);
+		_next.clear();
+		if(!_changed.empty()) {
+			_staged = true;
+			stage();
+		}
+	}
+
+private:
+	void finalize(Monitor& mon) override {
+		if(model().isComposed())
+			return;
+		auto p = source();
+		if(p == nullptr)
+			model().error("input port " + fullname() + " is dangling!");
+		else {
+			_source = static_cast<BusOutputPort<S> *>(p);
+			_source->_links.push_back(this);
+			if(model().sim().textTracing())
+				model().err() << fullname() << " connected to " << _source->fullname() << endl;
+		}
+	}
+
+	void receive(const Bus::Mask& m) {
+		if(staging())
+			_next.add(m);
+		else
+			_changed.add(m);
+		if(!_staged) {
+			_staged = true;
+			stage();
+		}
+		if(wake())
+			model().propagate(*this);
+	}
+
+	BusOutputPort<S> *_source;
+	Bus::Mask _changed, _next;
+	bool _staged;
+};
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_BUS_H_ */
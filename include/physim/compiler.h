@@ -0,0 +1,50 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_COMPILER_H_
+#define INCLUDE_PHYSIM_COMPILER_H_
+
+#include <physim.h>
+
+namespace physim {
+
+class NetworkCompiler {
+public:
+	NetworkCompiler(Simulation& sim);
+	void dump(ostream& out);
+	void generate(ostream& out, duration_t duration);
+
+private:
+	typedef enum {
+		REACTIVE,
+		PERIODIC,
+		OTHER
+	} kind_t;
+
+	kind_t kindOf(Model *model);
+	void collect(Model& model);
+
+	Simulation& _sim;
+	vector<Model *> _models;
+	map<Model *, int> _index;
+};
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_COMPILER_H_ */
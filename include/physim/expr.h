@@ -0,0 +1,177 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_EXPR_H_
+#define INCLUDE_PHYSIM_EXPR_H_
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <physim.h>
+
+/**
+ * @file
+ * Expression templates to build reactive models from arithmetic expressions
+ * over input ports, parameters and constants. Ports and parameters enter
+ * an expression with expr() and may then be combined with the usual
+ * arithmetic operators. The resulting expression is assigned to an output
+ * port of an ExprModel with ExprModel::define() and is evaluated inline,
+ * without intermediate ports or models.
+ *
+ * @code
+ * class Mix: public ExprModel {
+ * public:
+ * 	InputPort<double> x1, x2, x3;
+ * 	Parameter<double, 1> k1, k2;
+ * 	OutputPort<double> y;
+ * 	Mix(string name, ComposedModel *parent): ExprModel(name, parent),
+ * 		x1(this, "x1"), x2(this, "x2"), x3(this, "x3"),
+ * 		k1(this, "k1", 2), k2(this, "k2", 3), y(this, "y")
+ * 		{ define(y, expr(k1) * x1 + expr(k2) * x2 - x3); }
+ * };
+ * @endcode
+ */
+
+namespace physim {
+
+class ExprBase { };
+
+template <class X>
+struct is_expr: public std::is_base_of<ExprBase, X> { };
+
+template <class T>
+class ConstExpr: public ExprBase {
+public:
+	typedef T type;
+	inline ConstExpr(const T& x): _x(x) { }
+	inline type eval() const { return _x; }
+private:
+	T _x;
+};
+
+template <class P>
+class RefExpr: public ExprBase {
+public:
+	typedef typename std::decay<decltype(std::declval<const P&>()[0])>::type type;
+	inline RefExpr(const P& p, int i): _p(p), _i(i) { }
+	inline type eval() const { return _p[_i]; }
+private:
+	const P& _p;
+	int _i;
+};
+
+template <class O, class A>
+class UnaryExpr: public ExprBase {
+public:
+	typedef decltype(O::apply(std::declval<typename A::type>())) type;
+	inline UnaryExpr(const A& a): _a(a) { }
+	inline type eval() const { return O::apply(_a.eval()); }
+private:
+	A _a;
+};
+
+template <class O, class L, class R>
+class BinaryExpr: public ExprBase {
+public:
+	typedef decltype(O::apply(std::declval<typename L::type>(), std::declval<typename R::type>())) type;
+	inline BinaryExpr(const L& l, const R& r): _l(l), _r(r) { }
+	inline type eval() const { return O::apply(_l.eval(), _r.eval()); }
+private:
+	L _l;
+	R _r;
+};
+
+template <class X, class = void>
+struct Lift {
+	typedef ConstExpr<X> type;
+	static inline type make(const X& x) { return type(x); }
+};
+template <class X>
+struct Lift<X, typename std::enable_if<is_expr<X>::value>::type> {
+	typedef X type;
+	static inline const X& make(const X& x) { return x; }
+};
+template <class T, int N>
+struct Lift<InputPort<T, N>, void> {
+	typedef RefExpr<InputPort<T, N> > type;
+	static inline type make(const InputPort<T, N>& x) { return type(x, 0); }
+};
+template <class T, int N>
+struct Lift<Parameter<T, N>, void> {
+	typedef RefExpr<Parameter<T, N> > type;
+	static inline type make(const Parameter<T, N>& x) { return type(x, 0); }
+};
+
+template <class T, int N>
+inline RefExpr<InputPort<T, N> > expr(const InputPort<T, N>& p, int i = 0)
+	{ return RefExpr<InputPort<T, N> >(p, i); }
+template <class T, int N>
+inline RefExpr<Parameter<T, N> > expr(const Parameter<T, N>& p, int i = 0)
+	{ return RefExpr<Parameter<T, N> >(p, i); }
+template <class T>
+inline ConstExpr<T> expr(const T& x)
+	{ return ConstExpr<T>(x); }
+
+struct AddOp { template <class A, class B> static inline auto apply(const A& a, const B& b) -> decltype(a + b) { return a + b; } };
+struct SubOp { template <class A, class B> static inline auto apply(const A& a, const B& b) -> decltype(a - b) { return a - b; } };
+struct MulOp { template <class A, class B> static inline auto apply(const A& a, const B& b) -> decltype(a * b) { return a * b; } };
+struct DivOp { template <class A, class B> static inline auto apply(const A& a, const B& b) -> decltype(a / b) { return a / b; } };
+struct NegOp { template <class A> static inline auto apply(const A& a) -> decltype(-a) { return -a; } };
+
+#define PHYSIM_EXPR_BINARY(op, O) \
+	template <class L, class R, class = typename std::enable_if<is_expr<L>::value || is_expr<R>::value>::type> \
+	inline BinaryExpr<O, typename Lift<L>::type, typename Lift<R>::type> operator op(const L& l, const R& r) \
+		{ return BinaryExpr<O, typename Lift<L>::type, typename Lift<R>::type>(Lift<L>::make(l), Lift<R>::make(r)); }
+PHYSIM_EXPR_BINARY(+, AddOp)
+PHYSIM_EXPR_BINARY(-, SubOp)
+PHYSIM_EXPR_BINARY(*, MulOp)
+PHYSIM_EXPR_BINARY(/, DivOp)
+#undef PHYSIM_EXPR_BINARY
+
+template <class A, class = typename std::enable_if<is_expr<A>::value>::type>
+inline UnaryExpr<NegOp, A> operator-(const A& a)
+	{ return UnaryExpr<NegOp, A>(a); }
+
+
+class ExprModel: public ReactiveModel {
+public:
+	inline ExprModel(string name, ComposedModel *parent = nullptr)
+		: ReactiveModel(name, parent) { }
+
+protected:
+
+	template <class T, int N, class E>
+	void define(OutputPort<T, N>& y, const E& e, int i = 0) {
+		static_assert(is_expr<E>::value, "define() requires an expression built with expr()");
+		auto p = &y;
+		_eqs.push_back([p, e, i]() { (*p)[i] = e.eval(); });
+	}
+
+	void update() override {
+		for(const auto& e: _eqs)
+			e();
+	}
+
+private:
+	vector<std::function<void()> > _eqs;
+};
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_EXPR_H_ */
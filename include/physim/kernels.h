@@ -0,0 +1,199 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_KERNELS_H_
+#define INCLUDE_PHYSIM_KERNELS_H_
+
+#include <physim.h>
+
+namespace physim {
+
+/*
+ * The kernels below work directly on the storage of the ports. As array
+ * ports are aligned on a cache line and the loops are split on independent
+ * lanes, the compiler is able to vectorize them without any specific
+ * instruction set or floating-point relaxation.
+ */
+
+namespace kernel {
+
+const int lanes = 8;
+
+template <class T, int N>
+inline const T *data(const Port<T, N>& x) {
+#	ifdef __GNUC__
+		return static_cast<const T *>(__builtin_assume_aligned(x.data(), Port<T, N>::alignment));
+#	else
+		return x.data();
+#	endif
+}
+
+template <class T, int N>
+inline T *data(typename OutputPort<T, N>::Span& s) {
+#	ifdef __GNUC__
+		return static_cast<T *>(__builtin_assume_aligned(s.data(), Port<T, N>::alignment));
+#	else
+		return s.data();
+#	endif
+}
+
+} // kernel
+
+/**
+ * Compute the sum of the values of a port.
+ * @param x	Port to sum.
+ * @return	Sum of the values.
+ */
+template <class T, int N>
+T sum(const Port<T, N>& x) {
+	auto p = kernel::data(x);
+	T a[kernel::lanes] = { };
+	int i = 0;
+	for(; i + kernel::lanes <= N; i += kernel::lanes)
+		for(int k = 0; k < kernel::lanes; k++)
+			a[k] += p[i + k];
+	T r = T();
+	for(; i < N; i++)
+		r += p[i];
+	for(int k = 0; k < kernel::lanes; k++)
+		r += a[k];
+	return r;
+}
+
+/**
+ * Compute the dot product of the values of two ports.
+ * @param x	First port.
+ * @param y	Second port.
+ * @return	Sum of x[i] * y[i].
+ */
+template <class T, int N>
+T dot(const Port<T, N>& x, const Port<T, N>& y) {
+	auto p = kernel::data(x), q = kernel::data(y);
+	T a[kernel::lanes] = { };
+	int i = 0;
+	for(; i + kernel::lanes <= N; i += kernel::lanes)
+		for(int k = 0; k < kernel::lanes; k++)
+			a[k] += p[i + k] * q[i + k];
+	T r = T();
+	for(; i < N; i++)
+		r += p[i] * q[i];
+	for(int k = 0; k < kernel::lanes; k++)
+		r += a[k];
+	return r;
+}
+
+/**
+ * Compute the minimum of the values of a port.
+ * @param x	Port to look in.
+ * @return	Minimum value.
+ */
+template <class T, int N>
+T minimum(const Port<T, N>& x) {
+	auto p = kernel::data(x);
+	T r = p[0];
+	int i = 0;
+	if(N >= kernel::lanes) {
+		T a[kernel::lanes];
+		for(int k = 0; k < kernel::lanes; k++)
+			a[k] = p[k];
+		for(i = kernel::lanes; i + kernel::lanes <= N; i += kernel::lanes)
+			for(int k = 0; k < kernel::lanes; k++)
+				a[k] = p[i + k] < a[k] ? p[i + k] : a[k];
+		for(int k = 0; k < kernel::lanes; k++)
+			r = a[k] < r ? a[k] : r;
+	}
+	for(; i < N; i++)
+		r = p[i] < r ? p[i] : r;
+	return r;
+}
+
+/**
+ * Compute the maximum of the values of a port.
+ * @param x	Port to look in.
+ * @return	Maximum value.
+ */
+template <class T, int N>
+T maximum(const Port<T, N>& x) {
+	auto p = kernel::data(x);
+	T r = p[0];
+	int i = 0;
+	if(N >= kernel::lanes) {
+		T a[kernel::lanes];
+		for(int k = 0; k < kernel::lanes; k++)
+			a[k] = p[k];
+		for(i = kernel::lanes; i + kernel::lanes <= N; i += kernel::lanes)
+			for(int k = 0; k < kernel::lanes; k++)
+				a[k] = a[k] < p[i + k] ? p[i + k] : a[k];
+		for(int k = 0; k < kernel::lanes; k++)
+			r = r < a[k] ? a[k] : r;
+	}
+	for(; i < N; i++)
+		r = r < p[i] ? p[i] : r;
+	return r;
+}
+
+/**
+ * Compute y = a * x + y on the values of the ports. The consumers of y
+ * are touched at most once.
+ * @param a	Scale factor.
+ * @param x	Scaled port.
+ * @param y	Accumulating port.
+ */
+template <class T, int N>
+void axpy(const T& a, const Port<T, N>& x, OutputPort<T, N>& y) {
+	auto p = kernel::data(x);
+	auto s = y.span();
+	auto q = kernel::data<T, N>(s);
+	for(int i = 0; i < N; i++)
+		q[i] += a * p[i];
+}
+
+/**
+ * Compute y = a * x on the values of the ports. The consumers of y
+ * are touched at most once.
+ * @param a	Scale factor.
+ * @param x	Scaled port.
+ * @param y	Result port.
+ */
+template <class T, int N>
+void scale(const T& a, const Port<T, N>& x, OutputPort<T, N>& y) {
+	auto p = kernel::data(x);
+	auto s = y.span();
+	auto q = kernel::data<T, N>(s);
+	for(int i = 0; i < N; i++)
+		q[i] = a * p[i];
+}
+
+/**
+ * Scale in place the values of a port, y = a * y. The consumers of y
+ * are touched at most once.
+ * @param a	Scale factor.
+ * @param y	Scaled port.
+ */
+template <class T, int N>
+void scale(const T& a, OutputPort<T, N>& y) {
+	auto s = y.span();
+	auto q = kernel::data<T, N>(s);
+	for(int i = 0; i < N; i++)
+		q[i] *= a;
+}
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_KERNELS_H_ */
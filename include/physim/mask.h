@@ -0,0 +1,69 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_MASK_H_
+#define INCLUDE_PHYSIM_MASK_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace physim {
+
+/**
+ * Set of small integers, one bit per integer, stored in as many 64-bit
+ * words as needed. The words are kept when the mask is cleared so that
+ * a steady activity does not allocate.
+ */
+class Mask {
+public:
+	inline bool contains(int i) const
+		{ return size_t(i / 64) < _w.size() && (_w[i / 64] & (uint64_t(1) << (i % 64))) != 0; }
+	inline uint64_t word(int w) const { return size_t(w) < _w.size() ? _w[w] : 0; }
+	inline bool empty() const
+		{ for(auto w: _w) if(w != 0) return false; return true; }
+	inline bool only(int i) const {
+		for(size_t w = 0; w < _w.size(); w++)
+			if((_w[w] & ~(w == size_t(i / 64) ? uint64_t(1) << (i % 64) : 0)) != 0)
+				return false;
+		return true;
+	}
+	inline bool add(int i) {
+		if(size_t(i / 64) >= _w.size())
+			_w.resize(i / 64 + 1, 0);
+		auto b = uint64_t(1) << (i % 64);
+		auto w = _w[i / 64];
+		_w[i / 64] = w | b;
+		return (w & b) == 0;
+	}
+	inline void add(const Mask& m) {
+		if(m._w.size() > _w.size())
+			_w.resize(m._w.size(), 0);
+		for(size_t i = 0; i < m._w.size(); i++)
+			_w[i] |= m._w[i];
+	}
+	inline void clear() { std::fill(_w.begin(), _w.end(), 0); }
+	inline void swap(Mask& m) { _w.swap(m._w); }
+private:
+	std::vector<uint64_t> _w;
+};
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_MASK_H_ */
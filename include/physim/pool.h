@@ -0,0 +1,181 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_POOL_H_
+#define INCLUDE_PHYSIM_POOL_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace physim {
+
+const size_t cache_line = 64;
+
+template <class T>
+T *aligned_new(size_t n, size_t align) {
+	if(align < alignof(T))
+		align = alignof(T);
+	if(align < sizeof(void *))
+		align = sizeof(void *);
+	void *p;
+	if(posix_memalign(&p, align, n * sizeof(T)) != 0)
+		throw std::bad_alloc();
+	auto t = static_cast<T *>(p);
+	for(size_t i = 0; i < n; i++)
+		new(t + i) T();
+	return t;
+}
+
+template <class T>
+void aligned_delete(T *t, size_t n) {
+	if(t == nullptr)
+		return;
+	for(size_t i = 0; i < n; i++)
+		t[i].~T();
+	free(t);
+}
+
+class AbstractPool {
+public:
+	virtual ~AbstractPool() { }
+	virtual void release(void *p) = 0;
+};
+
+template <class T, int B = 64>
+class Pool: public AbstractPool {
+	union Slot {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+		Slot *next;
+	};
+public:
+	inline Pool(): _free(nullptr) { }
+	~Pool() { for(auto b: _blocks) aligned_delete(b, B); }
+
+	static Pool<T, B>& pool() { static Pool<T, B> p; return p; }
+
+	void *allocate() {
+		if(_free == nullptr) {
+			auto b = aligned_new<Slot>(B, alignof(Slot));
+			_blocks.push_back(b);
+			for(int i = 0; i < B; i++) {
+				b[i].next = _free;
+				_free = &b[i];
+			}
+		}
+		auto s = _free;
+		_free = s->next;
+		return s;
+	}
+
+	void release(void *p) override {
+		auto s = static_cast<Slot *>(p);
+		s->next = _free;
+		_free = s;
+	}
+
+private:
+	Slot *_free;
+	std::vector<Slot *> _blocks;
+};
+
+template <class T, size_t N, size_t A>
+class BufferPool {
+	struct alignas(A) Buffer { unsigned char data[N * sizeof(T)]; };
+	typedef Pool<Buffer, 16> pool_t;
+public:
+	static T *allocate() {
+		auto t = static_cast<T *>(pool_t::pool().allocate());
+		for(size_t i = 0; i < N; i++)
+			new(t + i) T();
+		return t;
+	}
+
+	static void release(T *t) {
+		if(t == nullptr)
+			return;
+		for(size_t i = 0; i < N; i++)
+			t[i].~T();
+		pool_t::pool().release(t);
+	}
+};
+
+/**
+ * @fn T *aligned_new(size_t n, size_t align);
+ * Allocate an array of n value-initialized objects of type T whose
+ * address is a multiple of align (at least alignof(T)). Must be released
+ * with aligned_delete().
+ * @param n		Number of objects.
+ * @param align	Required alignment in bytes.
+ * @return		Allocated array.
+ * @throw std::bad_alloc	If the memory cannot be allocated.
+ */
+
+/**
+ * @fn void aligned_delete(T *t, size_t n);
+ * Destroy and release an array allocated with aligned_new().
+ * @param t	Array to release (may be null).
+ * @param n	Number of objects in the array.
+ */
+
+/**
+ * @var cache_line
+ * Size in bytes of a cache line: array ports and the port arena are
+ * aligned on this boundary.
+ */
+
+/**
+ * @class Pool
+ * Pool of storage slots for objects of type T. The slots are allocated
+ * by blocks of B slots and released slots are kept in a free list, so
+ * that a steady allocation / release activity does not use the global
+ * allocator.
+ * @param T	Type of allocated objects.
+ * @param B	Number of slots per block (default 64).
+ */
+
+/**
+ * @class BufferPool
+ * Pool of arrays of N objects of type T aligned on A bytes, used for
+ * the buffers of the ports. The storage comes from a @ref Pool so that
+ * ports created and destroyed during the simulation do not use the
+ * global allocator once the pool is warm.
+ * @param T	Type of array items.
+ * @param N	Number of items.
+ * @param A	Alignment in bytes.
+ */
+
+/**
+ * @fn T *BufferPool::allocate();
+ * Allocate an array of N value-initialized objects.
+ * @return	Allocated array.
+ */
+
+/**
+ * @fn void BufferPool::release(T *t);
+ * Destroy the objects of an array obtained with allocate() and give
+ * back its storage to the pool.
+ * @param t	Array to release (may be null).
+ */
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_POOL_H_ */
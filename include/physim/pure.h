@@ -0,0 +1,107 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_PURE_H_
+#define INCLUDE_PHYSIM_PURE_H_
+
+#include <cstring>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <physim.h>
+
+namespace physim {
+
+class PureModel: public ReactiveModel {
+public:
+	typedef size_t (*hash_t)(const void *data, size_t size);
+	static size_t fnv(const void *data, size_t size);
+
+	PureModel(string name, ComposedModel *parent = nullptr, size_t size = 64);
+	inline size_t cacheSize() const { return _size; }
+	void setCacheSize(size_t size);
+	void setHash(hash_t hash);
+	void flush();
+	inline unsigned long long hits() const { return _hits; }
+	inline unsigned long long misses() const { return _misses; }
+
+protected:
+	void update() override;
+	virtual void compute() = 0;
+
+	template <class T, int N>
+	void memoize(InputPort<T, N>& port) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable ports can be memoized");
+		_ins.push_back(Slot(port, sizeof(T) * N, data<T, N>, nullptr));
+	}
+
+	template <class T, int N>
+	void memoize(OutputPort<T, N>& port) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable ports can be memoized");
+		_outs.push_back(Slot(port, sizeof(T) * N, data<T, N>, restore<T, N>));
+	}
+
+private:
+
+	class Slot {
+	public:
+		inline Slot(AbstractPort& p, size_t s, const void *(*d)(AbstractPort&), void (*r)(AbstractPort&, const char *))
+			: port(p), size(s), data(d), restore(r) { }
+		AbstractPort& port;
+		size_t size;
+		const void *(*data)(AbstractPort& port);
+		void (*restore)(AbstractPort& port, const char *data);
+	};
+
+	template <class T, int N>
+	static const void *data(AbstractPort& port)
+		{ return static_cast<Port<T, N>&>(port).data(); }
+
+	template <class T, int N>
+	static void restore(AbstractPort& port, const char *data) {
+		auto& op = static_cast<OutputPort<T, N>&>(port);
+		for(int i = 0; i < N; i++) {
+			T x;
+			memcpy(&x, data + i * sizeof(T), sizeof(T));
+			op[i] = x;
+		}
+	}
+
+	class Hash {
+	public:
+		inline Hash(): hash(fnv) { }
+		inline Hash(hash_t h): hash(h) { }
+		inline size_t operator()(const string& k) const { return hash(k.data(), k.size()); }
+		hash_t hash;
+	};
+
+	typedef list<pair<string, string> > lru_t;
+	typedef unordered_map<string, lru_t::iterator, Hash> map_t;
+
+	vector<Slot> _ins, _outs;
+	size_t _size;
+	lru_t _lru;
+	map_t _map;
+	string _key;
+	unsigned long long _hits, _misses;
+};
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_PURE_H_ */
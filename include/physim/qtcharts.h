@@ -33,25 +33,37 @@ class QtLineDisplay: public Model {
 		virtual ~AbstractReporter() { }
 		virtual string name() = 0;
 		virtual void record() = 0;
+		virtual void attach() = 0;
+		virtual void detach() = 0;
 		QColor color;
 		vector<double> vals;
 	};
 
 	template <class T, int N = 1>
-	class Reporter: public AbstractReporter {
+	class Reporter: public AbstractReporter, public OutputPort<T, N>::Observer {
 	public:
 		Reporter(QtLineDisplay *d, OutputPort<T, N>& port, int i = 0)
-			: AbstractReporter(d), out(port), in(d, ""), _i(i) { }
+			: AbstractReporter(d), out(port), src(nullptr), disp(d), _i(i), _v() { }
 		string name() override {
 			if(N == 1)
 				return out.fullname();
 			else
 				return out.fullname() + "[" + to_string(_i) + "]";
 		}
-		void record() override { vals.push_back(out[_i]); }
+		void record() override { vals.push_back(_v); }
+		void attach() override {
+			auto p = out.source();
+			src = p == nullptr ? &out : static_cast<OutputPort<T, N> *>(p);
+			src->observe(*this);
+			observe(src->data());
+		}
+		void detach() override { src->unobserve(*this); }
+		void observe(const T *x) override { _v = x[_i]; disp->touch(); }
 		OutputPort<T, N>& out;
-		InputPort<T, N> in;
+		OutputPort<T, N> *src;
+		QtLineDisplay *disp;
 		int _i;
+		T _v;
 	};
 
 public:
@@ -60,19 +72,17 @@ public:
 	~QtLineDisplay();
 
 	template <class T, int N>
-	void add(OutputPort<T, N>& port) {
-		auto r = new Reporter<T, N>(this, port);
-		_reps.push_back(r);
-		parent()->connect(port, r->in);
-	}
+	void add(OutputPort<T, N>& port)
+		{ _reps.push_back(new Reporter<T, N>(this, port)); }
 
 protected:
 	void start() override;
 	void stop() override;
 	void update() override;
-	void propagate(const AbstractPort& port) override;
 
 private:
+	inline void touch() { if(!_pending) { _pending = true; sim().triggerLast(*this); } }
+	bool _pending;
 	vector<AbstractReporter *> _reps;
 	vector<date_t> _dates;
 	int _color;
@@ -0,0 +1,167 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_SHARED_H_
+#define INCLUDE_PHYSIM_SHARED_H_
+
+#include <atomic>
+#include <initializer_list>
+#include <iostream>
+#include <utility>
+#include <physim/pool.h>
+#include <physim/type.h>
+
+namespace physim {
+
+/**
+ * @class Shared
+ * Reference-counted buffer of values of type T whose size is fixed at
+ * run time. A Shared is cheap to copy (only the reference count is
+ * incremented) and can be used as value type of ports to pass big data
+ * (images, point clouds, field snapshots) between models without deep
+ * copies: writing, publishing or reading such a port only shares
+ * the buffer.
+ *
+ * The buffer is immutable once shared: edit() gives access to the values
+ * and duplicates the buffer if it is referenced elsewhere. Two Shared
+ * are equal if they refer to the same buffer: writing a new buffer to
+ * a port changes it while writing again the same buffer does nothing.
+ * @code
+ * OutputPort<Shared<float>> image;
+ * ...
+ * Shared<float> s(w * h);
+ * render(s.edit());
+ * image = std::move(s);
+ * @endcode
+ * @param T	Type of the values.
+ */
+template <class T>
+class Shared {
+	struct Block {
+		std::atomic<long> refs;
+		size_t size;
+	};
+	static const size_t offset = (sizeof(Block) + cache_line - 1) / cache_line * cache_line;
+public:
+	inline Shared(): _b(nullptr) { }
+	explicit Shared(size_t n, const T& x = T()): _b(make(n))
+		{ for(size_t i = 0; i < n; i++) new(values() + i) T(x); }
+	Shared(const T *x, size_t n): _b(make(n))
+		{ for(size_t i = 0; i < n; i++) new(values() + i) T(x[i]); }
+	Shared(std::initializer_list<T> l): Shared(l.begin(), l.size()) { }
+	inline Shared(const Shared<T>& s): _b(s._b) { if(_b != nullptr) _b->refs++; }
+	inline Shared(Shared<T>&& s): _b(s._b) { s._b = nullptr; }
+	inline ~Shared() { drop(); }
+
+	inline Shared<T>& operator=(const Shared<T>& s)
+		{ if(s._b != nullptr) s._b->refs++; drop(); _b = s._b; return *this; }
+	inline Shared<T>& operator=(Shared<T>&& s)
+		{ if(this != &s) { drop(); _b = s._b; s._b = nullptr; } return *this; }
+
+	inline size_t size() const { return _b == nullptr ? 0 : _b->size; }
+	inline bool empty() const { return size() == 0; }
+	inline long count() const { return _b == nullptr ? 0 : _b->refs.load(); }
+	inline const T *data() const { return _b == nullptr ? nullptr : values(); }
+	inline const T& operator[](size_t i) const { return values()[i]; }
+	inline const T *begin() const { return data(); }
+	inline const T *end() const { return data() + size(); }
+
+	T *edit() {
+		if(_b != nullptr && _b->refs > 1)
+			*this = Shared<T>(data(), size());
+		return _b == nullptr ? nullptr : values();
+	}
+
+	inline bool operator==(const Shared<T>& s) const { return _b == s._b; }
+	inline bool operator!=(const Shared<T>& s) const { return _b != s._b; }
+
+private:
+	inline T *values() const { return reinterpret_cast<T *>(reinterpret_cast<char *>(_b) + offset); }
+
+	static Block *make(size_t n) {
+		void *p;
+		if(posix_memalign(&p, cache_line, offset + n * sizeof(T)) != 0)
+			throw std::bad_alloc();
+		auto b = static_cast<Block *>(p);
+		new(&b->refs) std::atomic<long>(1);
+		b->size = n;
+		return b;
+	}
+
+	void drop() {
+		if(_b != nullptr && --_b->refs == 0) {
+			auto v = values();
+			for(size_t i = 0; i < _b->size; i++)
+				v[i].~T();
+			_b->refs.~atomic();
+			free(_b);
+		}
+		_b = nullptr;
+	}
+
+	Block *_b;
+};
+
+/**
+ * @fn Shared::Shared(size_t n, const T& x);
+ * Build a buffer of n values initialized to x.
+ * @param n	Number of values.
+ * @param x	Initial value (default T()).
+ */
+
+/**
+ * @fn T *Shared::edit();
+ * Get a mutable access to the values. If the buffer is shared with other
+ * Shared objects (ports, consumers), it is first duplicated so that
+ * the other holders never see the modification.
+ * @return	Mutable values (null for an empty buffer).
+ */
+
+/**
+ * @fn long Shared::count() const;
+ * Get the number of Shared objects referring to the buffer.
+ * @return	Reference count (0 for an empty Shared).
+ */
+
+template <class T>
+inline unsigned long long hash_value(const Shared<T>& x, unsigned long long h) {
+	for(const auto& v: x)
+		h = hash_value(v, h);
+	return h;
+}
+
+template <class T>
+inline void snapshot_value(const Shared<T>& x, std::string& s) {
+	for(const auto& v: x)
+		snapshot_value(v, s);
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& out, const Shared<T>& x) {
+	out << '[';
+	for(size_t i = 0; i < x.size() && i < 8; i++)
+		out << (i == 0 ? "" : ", ") << x[i];
+	if(x.size() > 8)
+		out << ", ... (" << x.size() << ")";
+	return out << ']';
+}
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_SHARED_H_ */
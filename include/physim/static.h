@@ -0,0 +1,103 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_STATIC_H_
+#define INCLUDE_PHYSIM_STATIC_H_
+
+#include <physim.h>
+
+/**
+ * @file
+ * Statically dispatched counterparts of ReactiveModel and PeriodicModel.
+ * The model class M passes itself as template argument and provides
+ * a non-virtual compute() function that the base class calls directly,
+ * letting the compiler inline it in the update performed by the simulator.
+ *
+ * @code
+ * class Square: public StaticReactiveModel<Square> {
+ * 	friend class StaticReactiveModel<Square>;
+ * public:
+ * 	InputPort<int> x;
+ * 	OutputPort<int> y;
+ * 	Square(string name, ComposedModel *parent)
+ * 		: StaticReactiveModel<Square>(name, parent), x(this, "x"), y(this, "y") { }
+ * private:
+ * 	inline void compute() { y = x * x; }
+ * };
+ * @endcode
+ */
+
+namespace physim {
+
+template <class M>
+class StaticReactiveModel: public ReactiveModel {
+public:
+	inline StaticReactiveModel(string name, ComposedModel *parent = nullptr)
+		: ReactiveModel(name, parent) { }
+protected:
+	void update() final { static_cast<M *>(this)->compute(); }
+	void propagate(const AbstractPort& port) final { if(port.isFirstPending()) sim().trigger(*this); }
+};
+
+template <class M>
+class StaticPeriodicModel: public PeriodicModel {
+public:
+	inline StaticPeriodicModel(string name, duration_t period = 1, ComposedModel *parent = nullptr)
+		: PeriodicModel(name, period, parent) { }
+	inline StaticPeriodicModel(string name, ComposedModel *parent = nullptr)
+		: PeriodicModel(name, parent) { }
+protected:
+	void update(date_t date) final { static_cast<M *>(this)->compute(date); }
+	void propagate(const AbstractPort& port) final { PeriodicModel::propagate(port); }
+	void publish() final { static_cast<M *>(this)->publishOutputs(); }
+
+	inline void publishOutputs() { PeriodicModel::publish(); }
+
+	template <class T, int N>
+	static inline void publishPorts(OutputPort<T, N>& port)
+		{ port.OutputPort<T, N>::publish(); }
+	template <class T, int N, class... P>
+	static inline void publishPorts(OutputPort<T, N>& port, P&... ports)
+		{ port.OutputPort<T, N>::publish(); publishPorts(ports...); }
+};
+
+/**
+ * @class StaticReactiveModel
+ * Reactive model whose update is statically dispatched to the function
+ * compute() of M.
+ * @param M	Actual model class.
+ */
+
+/**
+ * @class StaticPeriodicModel
+ * Periodic model whose update is statically dispatched to the function
+ * compute(date_t date) of M.
+ *
+ * By default, the publication goes through all output ports of the model.
+ * M can shadow publishOutputs() and list its output ports with
+ * publishPorts() to publish them without virtual calls:
+ * @code
+ * inline void publishOutputs() { publishPorts(y, z); }
+ * @endcode
+ * @param M	Actual model class.
+ */
+
+} // physim
+
+#endif /* INCLUDE_PHYSIM_STATIC_H_ */
@@ -20,6 +20,7 @@
 #ifndef INCLUDE_PHYSIM_STD_H_
 #define INCLUDE_PHYSIM_STD_H_
 
+#include <deque>
 #include <physim.h>
 
 namespace physim {
@@ -65,20 +66,36 @@ class Report: public Model {
 		virtual ~AbstractReporter() { }
 		virtual string name() = 0;
 		virtual void print(ostream& out) = 0;
+		virtual void attach() = 0;
+		virtual void detach() = 0;
 	};
 
 	template <class T, int N = 1>
-	class Reporter: public AbstractReporter {
+	class Reporter: public AbstractReporter, public OutputPort<T, N>::Observer {
 	public:
 		Reporter(Report *report, OutputPort<T, N>& port)
-			: out(port), in(report, "") { }
+			: out(port), src(nullptr), r(report), vals() { }
 		string name() override { return out.fullname(); }
 		void print(ostream& out) {
-			out << in[0];
-			for(int i = 1; i < N; i++) out << ' ' << in[i];
+			out << vals[0];
+			for(int i = 1; i < N; i++) out << ' ' << vals[i];
+		}
+		void attach() override {
+			auto p = out.source();
+			src = p == nullptr ? &out : static_cast<OutputPort<T, N> *>(p);
+			src->observe(*this);
+			observe(src->data());
+		}
+		void detach() override { src->unobserve(*this); }
+		void observe(const T *x) override {
+			for(int i = 0; i < N; i++)
+				vals[i] = x[i];
+			r->touch();
 		}
 		OutputPort<T, N>& out;
-		InputPort<T, N> in;
+		OutputPort<T, N> *src;
+		Report *r;
+		T vals[N];
 	};
 
 public:
@@ -88,22 +105,22 @@ public:
 	~Report();
 
 	template <class T, int N>
-	void add(OutputPort<T, N>& port) {
-		auto r = new Reporter<T, N>(this, port);
-		_reps.push_back(r);
-		parent()->connect(port, r->in);
-	}
+	void add(OutputPort<T, N>& port)
+		{ _reps.push_back(new Reporter<T, N>(this, port)); }
 
 protected:
 	void start() override;
 	void stop() override;
 	void update() override;
-	void propagate(const AbstractPort& port) override;
+	void fastForward(date_t from, duration_t cycle, date_t count) override;
 
 private:
+	inline void touch() { if(!_pending) { _pending = true; sim().triggerLast(*this); } }
+	bool _pending;
 	ostream *_out;
 	string _path;
 	vector<AbstractReporter *> _reps;
+	deque<pair<date_t, string> > _rows;
 };
 
 } // physim
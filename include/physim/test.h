@@ -41,6 +41,10 @@ protected:
 		if(fabs(x[i] - ex) > prec) { err() << "failed: " << (date() - 1) << ": " << x.fullname() << ": expected " << ex << ", got " << x << endl; _failed = true; }
 	}
 
+	inline void check(bool cond, const string& msg) {
+		if(!cond) { err() << "failed: " << msg << endl; _failed = true; }
+	}
+
 private:
 	bool _failed;
 	int _error_cnt;
@@ -0,0 +1,149 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+#ifndef INCLUDE_PHYSIM_TRACE_H_
+#define INCLUDE_PHYSIM_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <physim/type.h>
+
+namespace physim {
+
+using namespace std;
+
+class TraceRecorder {
+public:
+
+	typedef enum {
+		NAME,
+		WRITE,
+		UPDATE,
+		TRIGGER,
+		INIT,
+		ACTIVATE,
+		RETIRE,
+		PARK,
+		RESUME,
+		RECONNECT,
+		WATCH,
+		STEADY
+	} kind_t;
+
+	typedef enum {
+		NONE,
+		SIGNED,
+		UNSIGNED,
+		FLOAT,
+		DOUBLE,
+		BOOL,
+		CHAR
+	} encoding_t;
+
+	class Event {
+	public:
+		date_t date;
+		uint64_t object;
+		uint64_t bits;
+		uint32_t index;
+		uint16_t kind;
+		uint16_t encoding;
+	};
+
+	TraceRecorder(const string& path, int capacity = 1 << 16);
+	~TraceRecorder();
+	inline bool isOpen() const { return _file != nullptr; }
+
+	void name(const void *object, const string& name, int size = 1);
+
+	inline void record(kind_t kind, date_t date, const void *object, uint64_t bits = 0, uint32_t index = 0) {
+		Event e = { date, uint64_t(reinterpret_cast<uintptr_t>(object)), bits, index, uint16_t(kind), NONE };
+		push(e);
+	}
+
+	template <class T>
+	inline void record(date_t date, const void *port, int index, const T& x) {
+		Event e = { date, uint64_t(reinterpret_cast<uintptr_t>(port)), 0, uint32_t(index), WRITE, encoding<T>() };
+		const size_t s = sizeof(T) < sizeof(e.bits) ? sizeof(T) : sizeof(e.bits);
+		if(e.encoding != NONE)
+			memcpy(&e.bits, &x, s);
+		if(e.encoding == SIGNED && s < sizeof(e.bits) && (e.bits >> (8 * s - 1)) != 0)
+			e.bits |= ~uint64_t(0) << (8 * s - 1);
+		push(e);
+	}
+
+	static bool decode(istream& in, ostream& out);
+
+private:
+
+	template <class T>
+	static inline uint16_t encoding() {
+		return std::is_same<T, bool>::value ? BOOL
+			: std::is_same<T, char>::value || std::is_same<T, signed char>::value
+				|| std::is_same<T, unsigned char>::value ? CHAR
+			: std::is_integral<T>::value && sizeof(T) <= 8 ? (std::is_signed<T>::value ? SIGNED : UNSIGNED)
+			: std::is_same<T, float>::value ? FLOAT
+			: std::is_same<T, double>::value ? DOUBLE
+			: NONE;
+	}
+
+	class Ring {
+	public:
+		Ring(int capacity);
+		vector<Event> events;
+		size_t mask;
+		atomic<size_t> head, tail;
+	};
+
+	inline void push(const Event& e) {
+		if(_owner != this)
+			attach();
+		auto r = _ring;
+		auto h = r->head.load(memory_order_relaxed);
+		while(h - r->tail.load(memory_order_acquire) > r->mask)
+			std::this_thread::yield();
+		r->events[h & r->mask] = e;
+		r->head.store(h + 1, memory_order_release);
+	}
+
+	void attach();
+	bool drain();
+	void run();
+
+	FILE *_file;
+	int _capacity;
+	mutex _lock;
+	vector<Ring *> _rings;
+	atomic<bool> _done;
+	thread _thread;
+	static thread_local TraceRecorder *_owner;
+	static thread_local Ring *_ring;
+};
+
+}	// physim
+
+#endif /* INCLUDE_PHYSIM_TRACE_H_ */
@@ -20,6 +20,9 @@
 #ifndef INCLUDE_PHYSIM_TYPE_H_
 #define INCLUDE_PHYSIM_TYPE_H_
 
+#include <string>
+#include <type_traits>
+
 namespace physim {
 
 typedef unsigned long long date_t;
@@ -36,7 +39,30 @@ typedef enum {
 	STATE
 } flavor_t;
 
+typedef enum {
+	STOP,
+	PAUSE
+} action_t;
+
 class Type { };
+
+inline unsigned long long hash_bytes(const void *data, unsigned long size, unsigned long long h = 14695981039346656037ULL) {
+	auto p = static_cast<const unsigned char *>(data);
+	for(unsigned long i = 0; i < size; i++) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+template <class T> inline unsigned long long hash_value(const T& x, unsigned long long h)
+	{ return hash_bytes(&x, sizeof(T), h); }
+inline unsigned long long hash_value(const std::string& x, unsigned long long h)
+	{ return hash_bytes(x.data(), x.size(), hash_value(x.size(), h)); }
+template <class T> inline void snapshot_value(const T& x, std::string& s)
+	{ s.append(reinterpret_cast<const char *>(&x), sizeof(T)); }
+inline void snapshot_value(const std::string& x, std::string& s)
+	{ snapshot_value(x.size(), s); s.append(x); }
+
 template <class T> const Type&type_of() { static Type t; return t; }
 template <class T> inline bool supports_real() { return false; }
 template <> inline bool supports_real<bool>() { return true; }
@@ -71,6 +97,13 @@ inline long double as_real(float x) { return x; }
 inline long double as_real(double x) { return x; }
 inline long double as_real(long double x) { return x; }
 
+template <class T, class R>
+inline typename std::enable_if<std::is_arithmetic<T>::value>::type as_reals(const T *x, R *r, int n)
+	{ for(int i = 0; i < n; i++) r[i] = R(x[i]); }
+template <class T, class R>
+inline typename std::enable_if<!std::is_arithmetic<T>::value>::type as_reals(const T *x, R *r, int n)
+	{ for(int i = 0; i < n; i++) r[i] = R(); }
+
 }	// physim
 
 #endif /* INCLUDE_PHYSIM_TYPE_H_ */
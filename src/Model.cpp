@@ -18,7 +18,9 @@
  *  USA
  */
 
+#include <fstream>
 #include <physim.h>
+#include <physim/compiler.h>
 
 namespace physim {
 
@@ -29,7 +31,9 @@ namespace physim {
  */
 
 Model::Model(string name, ComposedModel *parent)
-	: _name(name), _parent(parent), _sim(nullptr)
+	: _name(name), _parent(parent), _sim(nullptr),
+	  _prev(nullptr), _next(nullptr), _pending(false), _retired(false), _staging(false),
+	  _scheds(0), _id(-1), _inputs(0), _pool(nullptr)
 {
 	if(_parent != nullptr)
 		_parent->subs.push_back(this);
@@ -43,7 +47,10 @@ Model::~Model() {
 
 /**
  * Called to update the model according to a propagation along
- * the given port. The default implementation does nothing.
+ * the given port. It is called once per touched input port until the
+ * model is updated: the following touches of an already pending port
+ * are coalesced (see @ref AbstractPort::wake()). The default
+ * implementation does nothing.
  * @param port	Updated port.
  */
 void Model::propagate(const AbstractPort& port) {
@@ -94,6 +101,21 @@ void Model::finalize(Simulation& sim) {
 }
 
 
+/**
+ * Called when the simulation fast-forwards a periodic steady state:
+ * the simulation state at the current date has already been observed
+ * at date from and the cycle between both dates is skipped count times.
+ * Models producing outputs along time (like reports) can use it to
+ * replay what they produced during the cycle. The default implementation
+ * does nothing.
+ * @param from		Start date of the cycle.
+ * @param cycle		Cycle duration (current date is from + cycle).
+ * @param count		Number of skipped cycles.
+ */
+void Model::fastForward(date_t from, duration_t cycle, date_t count) {
+}
+
+
 /**
  * Add an abstract value.
  * @param val	Added value.
@@ -123,6 +145,13 @@ string Model::fullname() const {
  * @return	Current date.
  */
 
+/**
+ * @fn int Model::id() const;
+ * Get the dense ID of the model, assigned when the simulation is built
+ * (see @ref Simulation::models()).
+ * @return	Model ID (-1 before the simulation is built or once retired).
+ */
+
 /**
  * Display information to the user.
  * @param msg	Message to display.
@@ -198,16 +227,25 @@ ReactiveModel::ReactiveModel(string name, ComposedModel *parent)
  */
 
 /**
- *
+ * Trigger the model when the first of its inputs becomes pending: the
+ * other inputs touched before the update do not trigger it again.
+ * @param port	Updated port.
  */
 void ReactiveModel::propagate(const AbstractPort& port) {
-	sim().trigger(*this);
+	if(port.isFirstPending())
+		sim().trigger(*this);
 }
 
 
 /**
  * @class class PeriodicModel
  * A model that is triggered periodically.
+ *
+ * When the state of the model reaches a fixed point that cannot change
+ * as long as its inputs does not change, update() can call @ref steady():
+ * the model is then parked, that is, it is no more scheduled until one of
+ * its input ports is touched. It then resumes at the next date of its
+ * period.
  */
 
 /**
@@ -217,7 +255,7 @@ void ReactiveModel::propagate(const AbstractPort& port) {
  * @param parent	Parent model (optional).
  */
 PeriodicModel::PeriodicModel(string name, duration_t period, ComposedModel *parent)
-	: Model(name, parent), _period(period) { }
+	: Model(name, parent), _period(period), _phase(0), _steady(false), _parked(false) { }
 
 /**
  * Construct a periodic model.
@@ -225,7 +263,7 @@ PeriodicModel::PeriodicModel(string name, duration_t period, ComposedModel *pare
  * @param parent	Parent model (optional).
  */
 PeriodicModel::PeriodicModel(string name, ComposedModel *parent)
-	: Model(name, parent), _period(1) { }
+	: Model(name, parent), _period(1), _phase(0), _steady(false), _parked(false) { }
 
 /**
  * @fn void PeriodicModel::update();
@@ -233,20 +271,51 @@ PeriodicModel::PeriodicModel(string name, ComposedModel *parent)
  * @param date	Current date.
  */
 
+/**
+ * @fn bool PeriodicModel::isParked() const;
+ * Test if the model is parked, that is, not scheduled until one of its
+ * inputs changes (see @ref steady()).
+ * @return	True if the model is parked, false else.
+ */
+
+/**
+ * @fn void PeriodicModel::steady();
+ * Called from update() to declare that the model is in a steady state:
+ * the model is parked until one of its input ports is touched.
+ */
+
 ///
 void PeriodicModel::start() {
 	Model::start();
+	_phase = date() % _period;
+	_parked = false;
 	sim().schedule(*this, date() + _period);
 }
 
 ///
 void PeriodicModel::propagate(const AbstractPort& port) {
+	if(_parked) {
+		_parked = false;
+		auto d = date() - date() % _period + _phase;
+		if(d <= date())
+			d += _period;
+		if(sim().tracing())
+			sim().trace(TraceRecorder::RESUME, *this, d);
+		sim().schedule(*this, d);
+	}
 }
 
 ///
 void PeriodicModel::update() {
+	_steady = false;
 	update(date());
-	sim().schedule(*this, date() + _period);
+	if(!_steady)
+		sim().schedule(*this, date() + _period);
+	else {
+		_parked = true;
+		if(sim().tracing())
+			sim().trace(TraceRecorder::PARK, *this);
+	}
 }
 
 ///
@@ -281,10 +350,10 @@ void ComposedModel::propagate(const AbstractPort& port) {
 void ComposedModel::init() {
 	Model::init();
 	if(sim().tracing())
-		err() << "TRACE: " << date() << ": init " << fullname() << endl;
+		sim().trace(TraceRecorder::INIT, *this);
 	for(auto m: subs) {
 		if(sim().tracing())
-			err() << "TRACE: " << date() << ": init " << m->fullname() << endl;
+			sim().trace(TraceRecorder::INIT, *m);
 		m->init();
 	}
 }
@@ -317,6 +386,13 @@ void ComposedModel::publish() {
 	Model::publish();
 }
 
+///
+void ComposedModel::fastForward(date_t from, duration_t cycle, date_t count) {
+	for(auto m: subs)
+		m->fastForward(from, cycle, count);
+	Model::fastForward(from, cycle, count);
+}
+
 
 /**
  * @class ApplicationModel
@@ -340,7 +416,7 @@ void ComposedModel::publish() {
  * @param name	Name of the application.
  */
 ApplicationModel::ApplicationModel(string name)
-	: ComposedModel(name), _sim(nullptr), _tracing(false)
+	: ComposedModel(name), _sim(nullptr), _tracing(false), _ff(false)
 	{ }
 
 /**
@@ -361,6 +437,19 @@ int ApplicationModel::run(int argc, char **argv) {
 	// prepare the simulation
 	_sim = new Simulation(*this);
 	_sim->setTracing(_tracing);
+	_sim->setFastForward(_ff);
+	TraceRecorder *rec = nullptr;
+	if(_trace != "") {
+		rec = new TraceRecorder(_trace);
+		if(!rec->isOpen()) {
+			errorOption("cannot open " + _trace);
+			delete rec;
+			delete _sim;
+			_sim = nullptr;
+			return 1;
+		}
+		_sim->setRecorder(rec);
+	}
 
 	// perform the simulation
 	_sim->start();
@@ -370,9 +459,17 @@ int ApplicationModel::run(int argc, char **argv) {
 	// finalize the simulation
 	delete _sim;
 	_sim = nullptr;
+	delete rec;
 	return r;
 }
 
+/**
+ * @fn void ApplicationModel::setTraceFile(const string& path);
+ * Record the trace of the simulation in the given binary file
+ * (see @ref TraceRecorder).
+ * @param path	Path of the trace file.
+ */
+
 /**
  * @fn int ApplicationModel::perform();
  * Perform the simulation action.
@@ -395,6 +492,16 @@ int ApplicationModel::parseOption(int& i, int argc, char **argv) {
 	}
 	else if(opt == "--tracing")
 		_tracing = true;
+	else if(opt == "--fast-forward")
+		_ff = true;
+	else if(opt == "--trace-file") {
+		i++;
+		if(i == argc) {
+			errorOption("--trace-file requires a FILE argument!");
+			return 1;
+		}
+		_trace = argv[i];
+	}
 	else {
 		errorOption("unknown option '" + opt + "'!");
 		return 1;
@@ -410,6 +517,8 @@ void ApplicationModel::dumpOptions() {
 	cerr << "OPTIONS includes:" << endl;
 	cerr << "-h, --help  display this message." << endl;
 	cerr << "--tracing   enable internal work tracing" << endl;
+	cerr << "--fast-forward  skip the cycles of a periodic steady state" << endl;
+	cerr << "--trace-file FILE  record a binary trace in FILE (see physim-trace)" << endl;
 }
 
 /**
@@ -434,6 +543,10 @@ void ApplicationModel::errorOption(const string& msg) {
  *
  * It provides the following additional options:
  * @param -d, --duration INT -- specify the duration in time unit.
+ * @param --dump-graph FILE -- dump the finalized model network to FILE.
+ * @param --compile FILE -- generate in FILE a C++ source running the model
+ * network with a static schedule (see @ref NetworkCompiler) instead of
+ * running the simulation.
  */
 
 /**
@@ -445,6 +558,23 @@ Simulate::Simulate(string name, duration_t d)
 
 ///
 int Simulate::perform() {
+	if(_dump != "") {
+		ofstream out(_dump);
+		if(out.fail()) {
+			errorOption("cannot open " + _dump);
+			return 1;
+		}
+		NetworkCompiler(sim()).dump(out);
+	}
+	if(_compile != "") {
+		ofstream out(_compile);
+		if(out.fail()) {
+			errorOption("cannot open " + _compile);
+			return 1;
+		}
+		NetworkCompiler(sim()).generate(out, _d);
+		return 0;
+	}
 	sim().run(_d);
 	return 0;
 }
@@ -467,6 +597,18 @@ int Simulate::parseOption(int& i, int argc, char **argv) {
 			return 1;
 		}
 	}
+	else if(arg == "--dump-graph" || arg == "--compile") {
+		i++;
+		if(i == argc) {
+			errorOption(arg + " requires a FILE argument!");
+			return 1;
+		}
+		if(arg == "--dump-graph")
+			_dump = argv[i];
+		else
+			_compile = argv[i];
+		return 0;
+	}
 	else
 		return ApplicationModel::parseOption(i, argc, argv);
 }
@@ -475,6 +617,8 @@ int Simulate::parseOption(int& i, int argc, char **argv) {
 void Simulate::dumpOptions() {
 	ApplicationModel::dumpOptions();
 	cerr << "-d, --duration INT  perform during the given time (default " << _d << ")" << endl;
+	cerr << "--dump-graph FILE   dump the model network to FILE" << endl;
+	cerr << "--compile FILE      generate in FILE a C++ source with a static schedule" << endl;
 }
 
 } // physim
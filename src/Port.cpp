@@ -36,7 +36,8 @@ namespace physim {
  * @param size		Size of the port.
  */
 AbstractPort::AbstractPort(Model *model, string name, mode_t mode, const Type& type, int size)
-	: _model(*model), _name(name), _mode(mode), _type(type), _size(size), _back(nullptr)
+	: _model(*model), _name(name), _mode(mode), _type(type), _size(size), _back(nullptr), _id(-1),
+	  _rank(mode == IN ? model->_inputs++ : -1)
 {
 	model->_ports.push_back(this);
 }
@@ -72,6 +73,209 @@ long double AbstractPort::asReal(int i) {
 	return 0;
 }
 
+/**
+ * Copy, as real values, the n values of the port starting at index i to
+ * the given buffer. This performs in one call the work of n calls to
+ * asReal() and the conversion is specialized for the type of the port.
+ * The values of ports not supporting reals are stored as 0.
+ * The default implementation stores 0.
+ * @param x		Buffer to store values in (at least n values).
+ * @param i		Index of the first value (default 0).
+ * @param n		Number of values (default, negative, up to the end of the port).
+ * @return		Number of stored values.
+ */
+int AbstractPort::gather(double *x, int i, int n) {
+	if(n < 0 || i + n > size())
+		n = size() - i;
+	for(int k = 0; k < n; k++)
+		x[k] = 0;
+	return n;
+}
+
+/**
+ * Same as @ref gather(double *, int, int) but stores float values.
+ * @param x		Buffer to store values in (at least n values).
+ * @param i		Index of the first value (default 0).
+ * @param n		Number of values (default, negative, up to the end of the port).
+ * @return		Number of stored values.
+ */
+int AbstractPort::gather(float *x, int i, int n) {
+	if(n < 0 || i + n > size())
+		n = size() - i;
+	for(int k = 0; k < n; k++)
+		x[k] = 0;
+	return n;
+}
+
+/**
+ * Copy, as real values, all the values of the given ports in sequence
+ * to the given buffer (see @ref gather(double *, int, int)).
+ * @param ports	Ports to gather.
+ * @param x		Buffer to store values in (at least the sum of the port sizes).
+ * @return		Number of stored values.
+ */
+int AbstractPort::gather(const vector<AbstractPort *>& ports, double *x) {
+	int n = 0;
+	for(auto p: ports)
+		n += p->gather(x + n);
+	return n;
+}
+
+/**
+ * Same as @ref gather(const vector<AbstractPort *>&, double *) but stores
+ * float values.
+ * @param ports	Ports to gather.
+ * @param x		Buffer to store values in (at least the sum of the port sizes).
+ * @return		Number of stored values.
+ */
+int AbstractPort::gather(const vector<AbstractPort *>& ports, float *x) {
+	int n = 0;
+	for(auto p: ports)
+		n += p->gather(x + n);
+	return n;
+}
+
+
+/**
+ * Test if the port is an output port consumed by input ports.
+ * The default implementation returns false.
+ * @return	True if the port is consumed, false else.
+ */
+bool AbstractPort::isConsumed() const {
+	return false;
+}
+
+/**
+ * Combine the current values of the port into a hash value (used to
+ * detect steady states of the simulation). The default implementation
+ * returns the hash unchanged.
+ * @param h		Hash to combine with.
+ * @return		Combined hash.
+ */
+unsigned long long AbstractPort::hash(unsigned long long h) {
+	return h;
+}
+
+/**
+ * Append the current values of the port to a snapshot of the simulation
+ * state (used to confirm steady states found by @ref hash()). The default
+ * implementation appends nothing.
+ * @param s		Snapshot to append to.
+ */
+void AbstractPort::snapshot(string& s) {
+}
+
+/**
+ * Get the size in bytes of a value of the port (used to lay out the
+ * port buffers, see @ref Simulation::pack()). The default implementation
+ * returns 0.
+ * @return	Size of a port value.
+ */
+size_t AbstractPort::itemSize() const {
+	return 0;
+}
+
+/**
+ * Move the buffers of the port into an arena allocated by the simulation.
+ * If base is null, only compute the place needed. The default
+ * implementation does nothing.
+ * @param base		Base address of the arena or null.
+ * @param offset	Offset of the first free byte in the arena.
+ * @return			Offset of the first free byte after the port buffers.
+ */
+size_t AbstractPort::pack(char *base, size_t offset) {
+	return offset;
+}
+
+/**
+ * Move back the buffers of the port from the simulation arena to the
+ * heap, before the arena is freed. The default implementation does nothing.
+ */
+void AbstractPort::unpack() {
+}
+
+/**
+ * Called when the model of the port is retired from the simulation
+ * to unlink an input port from its source. The default implementation
+ * does nothing.
+ */
+void AbstractPort::unlink() {
+}
+
+/**
+ * Called at the end of the update of the model to propagate the changes
+ * of an output port written during the update (see @ref stage()). Only
+ * the values written during the update are compared with their previous
+ * value. The default implementation does nothing.
+ */
+void AbstractPort::commit() {
+}
+
+/**
+ * @fn bool AbstractPort::staging() const;
+ * Test if the model of the port is being updated by the simulator: the
+ * changes of its output ports are then staged until the end of the update.
+ * @return	True if changes are staged, false else.
+ */
+
+/**
+ * @fn void AbstractPort::stage();
+ * Record the port as changed during the update of its model: the port
+ * will be committed (see @ref commit()) when the update returns.
+ */
+
+/**
+ * @fn bool AbstractPort::wake();
+ * Record that an input port has been touched in the pending-input bitmask
+ * of its model. The model is notified (with @ref Model::propagate())
+ * when the port becomes pending: the following touches of the port are
+ * coalesced until the model is updated. Each input port owns the bit of
+ * its rank among the input ports of the model, so that the mask grows
+ * with the number of inputs.
+ * @return	True if the model has to be notified, false else.
+ */
+
+/**
+ * @fn bool AbstractPort::isFirstPending() const;
+ * Test if the port is the only pending input of its model, that is,
+ * the first one touched since the last update of the model (see
+ * @ref wake()).
+ * @return	True if no other input of the model is pending, false else.
+ */
+
+/**
+ * Called when a watch of the port requires to stop or to pause the
+ * simulation (see @ref OutputPort::watch()). The request is applied at
+ * the end of the current date (see @ref Simulation::halt()).
+ * @param action	Action to perform on the simulation.
+ */
+void AbstractPort::watched(action_t action) {
+	auto& sim = _model.sim();
+	if(sim.tracing()) {
+		if(sim.recorder() != nullptr)
+			sim.recorder()->record(TraceRecorder::WATCH, sim.date(), this, 0, action);
+		else
+			_model.err() << "TRACE: " << sim.date() << ": watch on " << fullname()
+				<< (action == STOP ? " stops" : " pauses") << " the simulation" << endl;
+	}
+	sim.halt(action);
+}
+
+/**
+ * Trace the reconnection of an input port, in the recorder of the
+ * simulation if any, as text else.
+ * @param source	New source port.
+ */
+void AbstractPort::reconnected(const AbstractPort& source) {
+	auto& sim = _model.sim();
+	if(sim.recorder() != nullptr)
+		sim.recorder()->record(TraceRecorder::RECONNECT, sim.date(), this,
+			uint64_t(reinterpret_cast<uintptr_t>(&source)));
+	else
+		_model.err() << "TRACE: " << sim.date() << ": " << fullname()
+			<< " reconnected to " << source.fullname() << endl;
+}
+
 
 /**
  * @fn string AbstractPort::AbstractPort::name() const;
@@ -103,6 +307,13 @@ long double AbstractPort::asReal(int i) {
  * @return	Container model.
  */
 
+/**
+ * @fn int AbstractPort::id() const;
+ * Get the dense ID of the port, assigned when the simulation is built
+ * (see @ref Simulation::ports()).
+ * @return	Port ID (-1 before the simulation is built or once retired).
+ */
+
 /**
  * Get the source of the port.
  * @return	Source port or null if the port is itself an unlinked output
@@ -143,6 +354,8 @@ void AbstractPort::finalize(Monitor& mon) {
  * @class Port
  * Class representing a port providing data. This is the templated version
  * of AbstractPort.
+ * The output ports of periodic models are delayed (see @ref OutputPort).
+ *
  * @param T	Type of values in the port.
  * @param N	Size of the value in the port (default to 1).s
  */
@@ -174,6 +387,33 @@ void AbstractPort::finalize(Monitor& mon) {
  * @return		Value at index i.
  */
 
+/**
+ * @fn const T *Port::data() const;
+ * Get the raw storage of the port values (null as long as the port
+ * is not finalized).
+ * @return	Port values.
+ */
+
+/**
+ * @fn const T *Port::begin() const;
+ * Get a pointer to the first value of the port, allowing to iterate
+ * on the values without going through accessors.
+ * @return	First value.
+ */
+
+/**
+ * @fn const T *Port::end() const;
+ * Get a pointer after the last value of the port.
+ * @return	End of the values.
+ */
+
+/**
+ * @var Port::alignment
+ * Alignment in bytes of the storage of the port values: array ports
+ * (N > 1) are aligned on a cache line to let the compiler vectorize
+ * the loops over their values (see kernels.h).
+ */
+
 /**
  * @class OutputPort
  * Class representing an output port. In the opposite to InputPort,
@@ -189,6 +429,17 @@ void AbstractPort::finalize(Monitor& mon) {
  * tp[1] = 1e3;
  * @endcode
  *
+ * The output ports of periodic models are delayed: they are double
+ * buffered and the written values are only visible to the connected
+ * input ports when the port is published. The publication swaps both
+ * buffers, re-points the links (O(links)) and copies back to the new
+ * back buffer only the values written since the previous publication,
+ * each index being recorded once. When every value has been written,
+ * the publication only swaps: the copy-back (O(N)) is deferred to the
+ * next access of the model to the port and is skipped if the model
+ * rewrites the whole port with assign(). Values read through a base
+ * Port reference are not re-synchronized and may be stale until then.
+ *
  * @param T	Type of values in the port.
  * @param N	Size of the value in the port (default to 1).s
  */
@@ -200,6 +451,26 @@ void AbstractPort::finalize(Monitor& mon) {
  * @param name	Port name.
  */
 
+/**
+ * @class OutputPort::Observer
+ * Observer of an output port (see @ref observe()): observe() is called
+ * with the published values each time the port propagates a change.
+ * An observer is not a model: it is neither connected nor scheduled,
+ * so recording a change costs only the copy the observer performs.
+ */
+
+/**
+ * @fn void OutputPort::observe(Observer& o);
+ * Add an observer to the port.
+ * @param o	Added observer.
+ */
+
+/**
+ * @fn void OutputPort::unobserve(Observer& o);
+ * Remove an observer from the port.
+ * @param o	Removed observer.
+ */
+
 /**
  * @fn OutputPort<T, N>& OutputPort::operator=(const T& x);
  * Assign the value x to the port (if it is of size 1).
@@ -207,6 +478,15 @@ void AbstractPort::finalize(Monitor& mon) {
  * @return	Port itself (to chain assignments).
  */
 
+/**
+ * @fn OutputPort<T, N>& OutputPort::operator=(T&& x);
+ * Move the value x into the port (if it is of size 1). Ports of Shared
+ * payloads use it to hand over the buffer without touching the reference
+ * count.
+ * @param x	Moved value.
+ * @return	Port itself (to chain assignments).
+ */
+
 /**
  * @fn Accessor OutputPort::operator*();
  * Get an assignable reference to the port value (if it is of size 1).
@@ -220,6 +500,169 @@ void AbstractPort::finalize(Monitor& mon) {
  * @return		Reference to the indexed value.
  */
 
+/**
+ * @fn void OutputPort::assign(const T *x, int n, int i);
+ * Assign n values at once, starting at index i. The values are compared
+ * and copied in one pass and the consumers are touched only once.
+ * The values falling after the end of the port are ignored.
+ * @param x		Values to assign.
+ * @param n		Number of values (default to N).
+ * @param i		Index of the first assigned value (default to 0).
+ */
+
+/**
+ * @fn void OutputPort::assign(const T (&x)[N]);
+ * Assign all the values of the port at once (see @ref assign(const T *, int, int)).
+ * @param x		Values to assign.
+ */
+
+/**
+ * @fn void OutputPort::assign(const std::initializer_list<T>& l);
+ * Assign the first values of the port at once (see @ref assign(const T *, int, int)).
+ * @param l		Values to assign.
+ */
+
+/**
+ * @fn void OutputPort::assign(const vector<T>& v, int i);
+ * Assign the values of a vector at once, starting at index i
+ * (see @ref assign(const T *, int, int)).
+ * @param v		Values to assign.
+ * @param i		Index of the first assigned value (default to 0).
+ */
+
+/**
+ * @class OutputPort::Span
+ * Mutable view on the raw storage of an output port, bypassing the
+ * accessors. The values can be freely read and written during the life
+ * of the span; when it is destroyed, the changed values are propagated
+ * and the consumers are touched once (not at all if no value changed).
+ * If the port has a filter or watches, the values written through the
+ * span are passed to them as with @ref assign(): the port values are
+ * then saved when the span is opened.
+ * @code
+ * {
+ *		auto s = y.span();
+ *		for(int i = 0; i < s.size(); i++)
+ *			s[i] = x[i] * k;
+ * }
+ * @endcode
+ */
+
+/**
+ * @fn Span OutputPort::span();
+ * Open a mutable view on the values of the port.
+ * @return	Span on the port values.
+ */
+
+/**
+ * @class OutputPort::Batch
+ * Scoped guard grouping the writes to an output port: during the life of
+ * the guard, the changes of the port are recorded but the consumers are
+ * only touched once, when the guard is destroyed.
+ * @code
+ * {
+ *		OutputPort<double, 1024>::Batch b(y);
+ *		for(int i = 0; i < 1024; i++)
+ *			y[i] = x[i] * k;
+ * }
+ * @endcode
+ */
+
+/**
+ * @fn int OutputPort::watch(const predicate_t& pred, action_t action, int i);
+ * Watch the port: the predicate is evaluated, with the old and the new
+ * value, each time the port changes. When it holds, the simulation is
+ * stopped (STOP) or paused (PAUSE) at the end of the current date.
+ * Unchanged ports cost nothing. Inside an update, the predicate is
+ * evaluated once, when the update returns, with the value before the
+ * update and the final value.
+ * @code
+ * level.watch(rises_above(0.95), STOP);
+ * @endcode
+ * @param pred		Predicate to evaluate.
+ * @param action	Action on the simulation (default STOP).
+ * @param i			Index of the watched value (default 0).
+ * @return			Identifier of the watch (see @ref unwatch()).
+ */
+
+/**
+ * @fn int OutputPort::watch(const predicate_t& pred, const callback_t& fun, int i);
+ * Watch the port: the predicate is evaluated, with the old and the new
+ * value, each time the port changes. When it holds, the function is
+ * called with the current date and the new value.
+ * @param pred		Predicate to evaluate.
+ * @param fun		Function to call.
+ * @param i			Index of the watched value (default 0).
+ * @return			Identifier of the watch (see @ref unwatch()).
+ */
+
+/**
+ * @fn void OutputPort::setFilter(const filter_t& filter);
+ * Set the propagation policy of the port. The filter is called with the
+ * current and the written value, which it may adjust, on each write.
+ * The write is dropped if the filter returns false; otherwise, the port
+ * changes if the adjusted value differs from the current one.
+ * A null filter restores the default policy: any change is propagated.
+ * @param filter	Filter to use.
+ */
+
+/**
+ * @fn void OutputPort::setDeadband(const T& abs, const T& rel);
+ * Set a deadband policy on the port (send-on-delta): a written value is
+ * only taken into account if it differs from the current one by more
+ * than abs and by more than rel times the current value. Replaces the
+ * current propagation policy (see @ref setFilter()).
+ * @param abs	Absolute deadband.
+ * @param rel	Relative deadband (default to 0).
+ */
+
+/**
+ * @fn void OutputPort::setQuantum(const T& q);
+ * Set a quantization policy on the port: the written values are rounded
+ * to the closer multiple of q, so that changes smaller than the quantum
+ * are not propagated. Replaces the current propagation policy (see
+ * @ref setFilter()).
+ * @param q		Quantum.
+ */
+
+/**
+ * @fn void OutputPort::unwatch(int id);
+ * Remove a watch from the port. Can be called from a watch callback.
+ * @param id	Identifier of the watch.
+ */
+
+/**
+ * @fn std::function<bool(const T&, const T&)> above(const T& th);
+ * Build a watch predicate holding when the new value is greater than
+ * the threshold (see @ref OutputPort::watch()).
+ * @param th	Threshold.
+ * @return		Predicate.
+ */
+
+/**
+ * @fn std::function<bool(const T&, const T&)> below(const T& th);
+ * Build a watch predicate holding when the new value is less than
+ * the threshold (see @ref OutputPort::watch()).
+ * @param th	Threshold.
+ * @return		Predicate.
+ */
+
+/**
+ * @fn std::function<bool(const T&, const T&)> rises_above(const T& th);
+ * Build a watch predicate holding when the value crosses the threshold
+ * upward (see @ref OutputPort::watch()).
+ * @param th	Threshold.
+ * @return		Predicate.
+ */
+
+/**
+ * @fn std::function<bool(const T&, const T&)> falls_below(const T& th);
+ * Build a watch predicate holding when the value crosses the threshold
+ * downward (see @ref OutputPort::watch()).
+ * @param th	Threshold.
+ * @return		Predicate.
+ */
+
 /**
  * @class InputPort;
  * Class representing an input port. Input port values can only be read.
@@ -231,6 +674,9 @@ void AbstractPort::finalize(Monitor& mon) {
  * cout << tp[0] << ", " << tp[1] << ", " << tp[3] << endl;
  * @encode
  *
+ * When connected to the output of a periodic model, the port sees the
+ * published values (see @ref OutputPort).
+ *
  * @param T	Type of values in the port.
  * @param N	Size of the value in the port (default to 1).s
  */
@@ -242,6 +688,16 @@ void AbstractPort::finalize(Monitor& mon) {
  * @param name	Port name.
  */
 
+/**
+ * @fn void InputPort::reconnect(OutputPort<T, N>& op);
+ * Connect the port to another output port, possibly while the simulation
+ * is running. The port is unlinked from its current source and linked
+ * to the new one in constant time, and the model of the port is triggered.
+ * Only the port itself is reconnected: input ports of sub-models connected
+ * to it keep their current source.
+ * @param op	New source of the port.
+ */
+
 /**
  * @fn void InputPort::touch();
  * Inform the port that the corresponding OutputPort has been updated.
@@ -249,4 +705,58 @@ void AbstractPort::finalize(Monitor& mon) {
  * the port.
  */
 
+
+/**
+ * @class MessageOutputPort
+ * Output port sending messages instead of holding a value: the messages
+ * sent at the same date do not overwrite each other but are queued in
+ * the connected MessageInputPort's. The messages are delivered as soon
+ * as they are sent and their storage comes from a pool shared by all
+ * ports of the same message type, so that a high message rate does not
+ * use the global allocator. A message sent to several consumers is
+ * shared, not copied.
+ * @code
+ * MessageOutputPort<Packet> out;
+ * ...
+ * out.send(src, dst, payload);
+ * @endcode
+ * @param M	Type of messages.
+ */
+
+/**
+ * @fn void MessageOutputPort::send(A&&... args);
+ * Send a message built from the given arguments to the connected input
+ * ports. Nothing is built if the port is not connected.
+ * @param args	Arguments of the message constructor.
+ */
+
+/**
+ * @class MessageInputPort
+ * Input port receiving the messages of a MessageOutputPort. The messages
+ * received since the last update of the model form the batch of the port:
+ * the update drains the batch by iterating on it and the batch is released
+ * as soon as the update returns. Messages received while the model is
+ * updating belong to the next batch.
+ * @code
+ * void update() override {
+ *		for(const auto& p: in)
+ *			route(p);
+ * }
+ * @endcode
+ * @param M	Type of messages.
+ */
+
+/**
+ * @fn int MessageInputPort::size() const;
+ * Get the number of messages in the current batch.
+ * @return	Number of messages.
+ */
+
+/**
+ * @fn const M& MessageInputPort::operator[](int i) const;
+ * Get a message of the current batch.
+ * @param i	Index of the message.
+ * @return	Message at index i.
+ */
+
 } // physim
@@ -18,10 +18,29 @@
  *  USA
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include <physim.h>
+#ifdef __linux__
+#	include <sys/mman.h>
+#endif
 
 namespace physim {
 
+/*
+ * Collect the ports of a model and of its sub-models in depth-first order.
+ * @param model		Model to look in.
+ * @param ports		Vector to store ports in.
+ */
+static void collectPorts(Model& model, vector<AbstractPort *>& ports) {
+	for(auto p: model.ports())
+		ports.push_back(p);
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			collectPorts(*m, ports);
+}
+
+
 /**
  * @class Simulation
  * Class in charge of driving the simulation. It takes a top-level model and
@@ -46,18 +65,37 @@ Simulation::Simulation(Model& top):
  */
 Simulation::Simulation(Model& top, Monitor& mon):
 	_top(top),
+	_current(nullptr),
 	_date(0),
 	_mon(new TerminalMonitor()),
 	_mon_alloc(false),
 	_tracing(false),
+	_ff(false),
+	_hyper(0),
+	_horizon(0),
+	_halt(STOP),
+	_halting(false),
+	_arena(nullptr),
+	_rec(nullptr),
+	_indexed(false),
 	_state(STOPPED)
 {
 	_top.finalize(*this);
+	index(_top);
+	fuse();
+	pack();
 }
 
 ///
 Simulation::~Simulation() {
 	stop();
+	if(_arena != nullptr) {
+		vector<AbstractPort *> ps;
+		collectPorts(_top, ps);
+		for(auto p: ps)
+			p->unpack();
+		free(_arena);
+	}
 	if(_mon_alloc)
 		delete _mon;
 }
@@ -68,26 +106,53 @@ Simulation::~Simulation() {
  */
 void Simulation::start() {
 	if(_state == STOPPED) {
-		if(tracing())
+		if(textTracing()) {
 			_mon->err() << "TRACE: starting the simulation." << endl;
+			for(const auto& c: _chains) {
+				_mon->err() << "TRACE: fused chain " << c[0]->fullname();
+				for(size_t i = 1; i < c.size(); i++)
+					_mon->err() << " -> " << c[i]->fullname();
+				_mon->err() << endl;
+			}
+		}
 		_date = 0;
+		_horizon = 0;
+		_halting = false;
+		_hashes.clear();
+		if(_ff) {
+			vector<Model *> models;
+			collect(_top, models);
+			_hyper = 1;
+			for(auto m: models) {
+				auto p = dynamic_cast<PeriodicModel *>(m);
+				if(p != nullptr) {
+					duration_t a = _hyper, b = p->period();
+					while(b != 0) {
+						auto r = a % b;
+						a = b;
+						b = r;
+					}
+					_hyper = _hyper / a * p->period();
+				}
+			}
+		}
 		_top.start();
-		if(tracing())
+		if(textTracing())
 			_mon->err() << "TRACE: initializing the simulation." << endl;
+		initValues(_top);
 		_top.init();
 		_top.publish();
 
 		while(!_todo.empty() && _state != STOPPED) {
 			auto m = *_todo.begin();
 			_todo.erase(m);
-			if(tracing())
-				_mon->err() << "TRACE: " << _date << ": updating " << m->fullname() << endl;
-			m->update();
+			update(*m);
 		}
 
-		if(tracing())
+		if(textTracing())
 			_mon->err() << "TRACE: simulation paused." << endl;
 		_state = PAUSED;
+		applyHalt();
 	}
 }
 
@@ -110,16 +175,19 @@ void Simulation::run() {
 void Simulation::run(duration_t duration) {
 	start();
 	_state = RUNNING;
-	if(_tracing)
+	if(textTracing())
 		_mon->err() << "TRACE: simulation running." << endl;
-	while(_state == RUNNING && duration != 0) {
+	date_t end = _date + duration;
+	while(_state == RUNNING && _date < end) {
 		//cerr << "DEBUG: step " << _date << endl;
-		advance();
-		duration--;
+		if(_ff)
+			detect(end);
+		if(_date < end)
+			advance();
 	}
 	if(_state == RUNNING) {
 		_state = PAUSED;
-		if(_tracing)
+		if(textTracing())
 			_mon->err() << "TRACE: simulation paused." << endl;
 	}
 }
@@ -131,8 +199,12 @@ void Simulation::run(duration_t duration) {
 void Simulation::runUntil(date_t date) {
 	start();
 	_state = RUNNING;
-	while(_state == RUNNING && _date < date)
-		advance();
+	while(_state == RUNNING && _date < date) {
+		if(_ff)
+			detect(date);
+		if(_date < date)
+			advance();
+	}
 	if(_state == RUNNING)
 		_state = PAUSED;
 }
@@ -158,42 +230,383 @@ void Simulation::advance() {
 
 	// pump read dates
 	while(!_sched.empty() && _sched.top().at == _date) {
-		_pers.push_back(_sched.top().model);
+		auto m = _sched.top().model;
 		_sched.pop();
+		m->_scheds--;
+		if(!m->_retired)
+			_pers.push_back(m);
 	}
 
 	// perform periodic models
-	for(auto p: _pers) {
-		if(tracing())
-			_mon->err() << "TRACE: " << _date << ": updating " << p->fullname() << endl;
-		p->update();
-	}
+	for(auto p: _pers)
+		update(*p);
 	for(auto p: _pers)
 		p->publish();
 	_pers.clear();
+	settle();
+}
+
+/*
+ * Perform the reactive part of a simulation step, that is, update the
+ * triggered models until they are stable, and go to the next date.
+ */
+void Simulation::settle() {
 
 	// pump models that needs to be updated
 	while(! _todo.empty() && _state != STOPPED) {
 		auto m = *_todo.begin();
 		_todo.erase(m);
-		if(tracing())
-			_mon->err() << "TRACE: " << _date << ": updating " << m->fullname() << endl;
-		m->update();
+		update(*m);
 	}
 
 	// trigger last models
 	while(!_last.empty()) {
 		auto m = *_last.begin();
 		_last.erase(m);
-		if(tracing())
-			_mon->err() << "TRACE: " << _date << ": updating " << m->fullname() << endl;
-		m->update();
+		update(*m);
 	}
 
+	// release retired models
+	if(!_dead.empty())
+		release();
+
 	// next date
 	_date++;
+	applyHalt();
+}
+
+
+/**
+ * Ask the simulation to stop or to pause at the end of the current date:
+ * the models triggered at this date are still updated. If several
+ * requests are made at the same date, a stop wins over a pause.
+ * @param action	STOP or PAUSE.
+ */
+void Simulation::halt(action_t action) {
+	if(!_halting || action == STOP)
+		_halt = action;
+	_halting = true;
+}
+
+
+/*
+ * Apply the pending stop or pause request (see @ref halt()).
+ */
+void Simulation::applyHalt() {
+	if(!_halting)
+		return;
+	_halting = false;
+	if(_halt == STOP)
+		stop();
+	else
+		pause();
+}
+
+
+/**
+ * Update the given model and, if it heads a fused chain, the following
+ * stages of the chain that have been triggered by their predecessor.
+ * @param model	Model to update.
+ */
+void Simulation::update(Model& model) {
+	_current = &model;
+	perform(model);
+	for(auto m = model._next; m != nullptr && m->_pending; m = m->_next) {
+		m->_pending = false;
+		_current = m;
+		perform(*m);
+	}
+	_current = nullptr;
+}
+
+
+/*
+ * Call the update of a model in a write transaction: the outputs written
+ * by the model are staged and only their final values are propagated
+ * when the update returns.
+ * The pending-input mask of the model is cleared first, so that the
+ * inputs touched from now on wake the model again.
+ * @param model		Model to update.
+ */
+void Simulation::perform(Model& model) {
+	if(tracing())
+		trace(TraceRecorder::UPDATE, model);
+	model._waiting.clear();
+	model._staging = true;
+	model.update();
+	model._staging = false;
+	if(!model._staged.empty()) {
+		auto n = model._staged.size();
+		for(size_t i = 0; i < n; i++)
+			model._staged[i]->commit();
+		model._staged.erase(model._staged.begin(), model._staged.begin() + n);
+	}
+}
+
+
+/**
+ * Collect the leaf models of the model tree.
+ * @param model		Current model.
+ * @param models	Vector to collect models in.
+ */
+void Simulation::collect(Model& model, vector<Model *>& models) {
+	if(!model.isComposed())
+		models.push_back(&model);
+	else
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			collect(*m, models);
+}
+
+
+/**
+ * Move the buffers of the output ports into a single arena allocated
+ * once the ports are finalized. The buffers are grouped by decreasing
+ * item size, then by type, then array ports before scalar ones, so that
+ * the values of a same type are contiguous and the alignment padding is
+ * kept low; inside a group, the depth-first order of the models is
+ * preserved. Big arenas
+ * are aligned on huge pages and, on Linux, advised to use them.
+ * If the arena cannot be allocated, the ports keep their own buffers.
+ * Models activated during the simulation keep their own buffers too.
+ */
+void Simulation::pack() {
+	static const size_t huge_page = 2 << 20;
+	vector<AbstractPort *> ps;
+	collectPorts(_top, ps);
+	stable_sort(ps.begin(), ps.end(), [](AbstractPort *p, AbstractPort *q) {
+		if(p->itemSize() != q->itemSize())
+			return p->itemSize() > q->itemSize();
+		if(&p->type() != &q->type())
+			return less<const Type *>()(&p->type(), &q->type());
+		return (p->size() > 1) > (q->size() > 1);
+	});
+	size_t size = 0;
+	for(auto p: ps)
+		size = p->pack(nullptr, size);
+	if(size == 0)
+		return;
+	size_t align = size >= huge_page ? huge_page : cache_line;
+	size = (size + align - 1) / align * align;
+	void *mem;
+	if(posix_memalign(&mem, align, size) != 0)
+		return;
+#	if defined(__linux__) && defined(MADV_HUGEPAGE)
+		if(align == huge_page)
+			madvise(mem, size, MADV_HUGEPAGE);
+#	endif
+	_arena = static_cast<char *>(mem);
+	size = 0;
+	for(auto p: ps)
+		size = p->pack(_arena, size);
+}
+
+
+/**
+ * Fuse the chains of reactive models linked by single-consumer links.
+ * A reactive model B is fused after a reactive model A if A outputs are
+ * only consumed by B and B inputs are only produced by A. The stages of
+ * a fused chain are updated back-to-back by the head of the chain without
+ * passing by the scheduler. The fused chains can be obtained with
+ * @ref chains().
+ */
+void Simulation::fuse() {
+
+	// compute producers and consumers
+	vector<Model *> models;
+	collect(_top, models);
+	map<Model *, set<Model *> > prods, conss;
+	for(auto m: models)
+		for(auto p: m->ports())
+			if(p->mode() == IN) {
+				auto s = p->source();
+				if(s != nullptr) {
+					prods[m].insert(&s->model());
+					conss[&s->model()].insert(m);
+				}
+			}
+
+	// link the stages
+	for(auto m: models) {
+		if(dynamic_cast<ReactiveModel *>(m) == nullptr)
+			continue;
+		const auto& cs = conss[m];
+		if(cs.size() != 1)
+			continue;
+		auto n = *cs.begin();
+		if(n == m || dynamic_cast<ReactiveModel *>(n) == nullptr || prods[n].size() != 1)
+			continue;
+		auto l = n->_next;
+		while(l != nullptr && l != m)
+			l = l->_next;
+		if(l == m)
+			continue;
+		m->_next = n;
+		n->_prev = m;
+	}
+
+	// record the chains
+	for(auto m: models)
+		if(m->_prev == nullptr && m->_next != nullptr) {
+			_chains.push_back(vector<Model *>());
+			for(auto n = m; n != nullptr; n = n->_next)
+				_chains.back().push_back(n);
+		}
+}
+
+
+/**
+ * @fn const vector<vector<Model *> >& Simulation::chains() const;
+ * Get the chains of reactive models fused at finalization time
+ * (see @ref fuse()).
+ * @return	Fused chains, each one from its head to its last stage.
+ */
+
+
+/**
+ * Set the values of a model and of its sub-models to their initial value.
+ * @param model		Model to initialize.
+ */
+void Simulation::initValues(Model& model) {
+	for(auto v: model._vals)
+		v->init();
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			initValues(*m);
 }
 
+/**
+ * Combine the state of a model and of its sub-models into a hash:
+ * the port values, the state values and the parking of periodic models.
+ * The pending schedules are combined by @ref detect().
+ * @param model	Model to hash.
+ * @param h		Hash to combine with.
+ * @return		Combined hash.
+ */
+unsigned long long Simulation::hash(Model& model, unsigned long long h) {
+	for(auto p: model.ports())
+		h = p->hash(h);
+	for(auto v: model._vals)
+		h = v->hash(h);
+	auto pm = dynamic_cast<PeriodicModel *>(&model);
+	if(pm != nullptr)
+		h = hash_value(pm->_parked, h);
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			h = hash(*m, h);
+	return h;
+}
+
+/**
+ * Append the state of a model and of its sub-models to a snapshot, in
+ * the same order as @ref hash().
+ * @param model	Model to record.
+ * @param s		Snapshot to append to.
+ */
+void Simulation::snapshot(Model& model, string& s) {
+	for(auto p: model.ports())
+		p->snapshot(s);
+	for(auto v: model._vals)
+		v->snapshot(s);
+	auto pm = dynamic_cast<PeriodicModel *>(&model);
+	if(pm != nullptr)
+		snapshot_value(pm->_parked, s);
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			snapshot(*m, s);
+}
+
+
+/**
+ * Detect a periodic steady state and fast-forward it. At each hyperperiod
+ * boundary (least common multiple of the periods of the periodic models),
+ * the state of the simulation is hashed and recorded as a snapshot. If
+ * the same hash has been found at a previous boundary and the snapshots
+ * are equal, the simulation is in a steady state whose cycle is the
+ * distance between both dates: the date is advanced by as many whole
+ * cycles as fit before the end date and the models are informed with
+ * @ref Model::fastForward().
+ *
+ * Only the state visible to the simulator is considered: ports and
+ * @ref State values. Models with other internal state should expose it
+ * as State values to use fast-forwarding.
+ * @param end	End date of the simulation.
+ */
+void Simulation::detect(date_t end) {
+	if(_hyper == 0 || _date % _hyper != 0)
+		return;
+
+	// look for the state
+	auto h = hash(_top, hash_bytes(nullptr, 0));
+	string s;
+	snapshot(_top, s);
+	auto q = _sched;
+	while(!q.empty()) {
+		h = hash_value(q.top().at - _date, h);
+		h = hash_value(q.top().model, h);
+		snapshot_value(q.top().at - _date, s);
+		snapshot_value(q.top().model, s);
+		q.pop();
+	}
+	auto i = _hashes.find(h);
+	if(i == _hashes.end() || i->second.second != s) {
+		if(i == _hashes.end() && _hashes.size() >= 1024) {
+			_hashes.clear();
+			_horizon = _date;
+		}
+		_hashes[h] = make_pair(_date, std::move(s));
+		return;
+	}
+
+	// fast-forward the cycles
+	auto from = i->second.first;
+	duration_t cycle = _date - from;
+	date_t count = (end - _date) / cycle;
+	if(count == 0)
+		return;
+	if(tracing()) {
+		if(_rec != nullptr)
+			_rec->record(TraceRecorder::STEADY, _date, &_top, count, uint32_t(cycle));
+		else
+			_mon->err() << "TRACE: " << _date << ": steady state since " << from
+				<< ", fast-forwarding " << count << " cycle(s) of " << cycle << endl;
+	}
+	vector<Date> ds;
+	while(!_sched.empty()) {
+		ds.push_back(_sched.top());
+		_sched.pop();
+	}
+	for(auto d: ds) {
+		d.at += count * cycle;
+		_sched.push(d);
+	}
+	_top.fastForward(from, cycle, count);
+	_date += count * cycle;
+	_hashes.clear();
+	_horizon = _date;
+}
+
+
+/**
+ * @fn bool Simulation::fastForwarding() const;
+ * Test if the detection of periodic steady states is enabled
+ * (see @ref detect()).
+ * @return	True if fast-forwarding is enabled, false else.
+ */
+
+/**
+ * @fn void Simulation::setFastForward(bool ff);
+ * Enable or disable the detection and fast-forwarding of periodic steady
+ * states (see @ref detect()). Must be set before starting the simulation.
+ * @param ff	True to enable, false to disable.
+ */
+
+/**
+ * @fn date_t Simulation::horizon() const;
+ * Get the oldest date a fast-forward cycle may start from. Models replaying
+ * their production on fast-forward can forget what was produced before.
+ * @return	Horizon date.
+ */
+
 
 /**
  * Ask to trigger the given model as soon as possible.
@@ -202,12 +615,81 @@ void Simulation::advance() {
 void Simulation::trigger(Model& model) {
 	//_mon->err() << "DEBUG: state = " << _state << endl;
 	//if(not isStopped())
-	_todo.insert(&model);
+	if(model._prev != nullptr && model._prev == _current)
+		model._pending = true;
+	else
+		_todo.insert(&model);
 	if(tracing())
-		_mon->err() << "TRACE: " << date() << ": trigger " << model.fullname() << endl;
+		trace(TraceRecorder::TRIGGER, model);
+}
+
+
+/*
+ * Trace an event about a model, in the recorder if any, as text else.
+ * @param kind	Kind of event (UPDATE, TRIGGER, INIT, ACTIVATE, RETIRE,
+ *				PARK or RESUME).
+ * @param model	Concerned model.
+ * @param at	Date the model is resumed at (RESUME only).
+ */
+void Simulation::trace(TraceRecorder::kind_t kind, Model& model, date_t at) {
+	if(_rec != nullptr) {
+		_rec->record(kind, _date, &model, at);
+		return;
+	}
+	auto& out = _mon->err();
+	out << "TRACE: " << _date << ": ";
+	switch(kind) {
+	case TraceRecorder::UPDATE:		out << "updating "; break;
+	case TraceRecorder::TRIGGER:	out << "trigger "; break;
+	case TraceRecorder::ACTIVATE:	out << "activating "; break;
+	case TraceRecorder::RETIRE:		out << "retiring "; break;
+	case TraceRecorder::PARK:		out << "parking "; break;
+	case TraceRecorder::RESUME:		out << "resuming "; break;
+	default:						out << "init "; break;
+	}
+	out << model.fullname();
+	if(kind == TraceRecorder::RESUME)
+		out << " at " << at;
+	out << endl;
 }
 
 
+/**
+ * Record the trace of the simulation in the given recorder instead of
+ * displaying it as text, and enable the tracing. The names of the models
+ * and of the ports are recorded to decode the trace. The messages that
+ * have no recorded form (start, pause, connections) are not displayed
+ * while a recorder is attached (see @ref textTracing()).
+ * @param rec	Recorder to use (null to come back to text tracing).
+ */
+void Simulation::setRecorder(TraceRecorder *rec) {
+	_rec = rec;
+	if(_rec != nullptr) {
+		_tracing = true;
+		record(_top);
+	}
+}
+
+/*
+ * Record the names of a model, of its ports and of its sub-models.
+ * @param model		Model to record.
+ */
+void Simulation::record(Model& model) {
+	_rec->name(&model, model.fullname());
+	for(auto p: model.ports())
+		_rec->name(p, p->fullname(), p->size());
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			record(*m);
+}
+
+/**
+ * @fn TraceRecorder *Simulation::recorder() const;
+ * Get the current trace recorder.
+ * @return	Current trace recorder or null.
+ */
+
+
 /**
  * Ask the model to be triggered in an epilog phase.
  * Typical use is for reporting once the system is stable.
@@ -228,10 +710,331 @@ void Simulation::schedule(Model& model, date_t at) {
 	//cerr << "DEBUG: " << _date << ": " << model.fullname() << " scheduled at " << at << endl;
 	if(at <= _date)
 		_mon->warn("model " + model.fullname() + " ask scheduling at date in the past: " + to_string(at));
-	else
+	else {
 		_sched.push(Date(at, model));
+		model._scheds++;
+	}
+}
+
+
+/**
+ * Test if an output of a model or of its sub-models is consumed.
+ * @param model		Model to test.
+ * @return			True if an output is consumed, false else.
+ */
+static bool consumed(Model& model) {
+	for(auto p: model.ports())
+		if(p->mode() == OUT && p->isConsumed())
+			return true;
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			if(consumed(*m))
+				return true;
+	return false;
 }
 
+/**
+ * Activate a model created during the simulation (see @ref create()):
+ * its ports are linked and, if the simulation is started, the model
+ * is started, initialized and its outputs are published. The inputs
+ * of the model must be connected before the activation.
+ * @param model		Model to activate.
+ */
+void Simulation::activate(Model& model) {
+	model.finalize(*this);
+	index(model);
+	if(_rec != nullptr)
+		record(model);
+	if(_state != STOPPED) {
+		if(tracing())
+			trace(TraceRecorder::ACTIVATE, model);
+		model.start();
+		initValues(model);
+		model.init();
+		model.publish();
+		if(dynamic_cast<ReactiveModel *>(&model) != nullptr)
+			trigger(model);
+	}
+}
+
+
+/**
+ * Retire a model from the simulation: its input ports are unlinked, it is
+ * stopped and removed from its parent. If the model has been obtained
+ * with @ref create(), it is destroyed and its storage returned to its
+ * pool at the end of the current date (or when its pending schedule is
+ * reached for a periodic model).
+ *
+ * The output ports of the model must not be consumed anymore, that is,
+ * consumer models have to be retired before.
+ * @param model		Model to retire.
+ */
+void Simulation::retire(Model& model) {
+	if(model._retired)
+		return;
+	if(tracing())
+		trace(TraceRecorder::RETIRE, model);
+	if(consumed(model)) {
+		_mon->error("cannot retire " + model.fullname() + ": its outputs are still consumed");
+		return;
+	}
+	detach(model);
+	unindex(model);
+	if(_state != STOPPED)
+		model.stop();
+	auto p = model.parent();
+	if(p != nullptr)
+		for(size_t i = 0; i < p->subs.size(); i++)
+			if(p->subs[i] == &model) {
+				p->subs.erase(p->subs.begin() + i);
+				break;
+			}
+	_dead.push_back(&model);
+	if(_state == STOPPED)
+		release();
+}
+
+
+/**
+ * Count the pending schedules of a model and of its sub-models.
+ * @param model		Model to look at.
+ * @return			Count of pending schedules.
+ */
+int Simulation::scheduled(Model& model) {
+	int c = model._scheds;
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			c += scheduled(*m);
+	return c;
+}
+
+/**
+ * Detach a model (and its sub-models) from the model network.
+ * @param model		Model to detach.
+ */
+void Simulation::detach(Model& model) {
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			detach(*m);
+	for(auto p: model.ports())
+		if(p->mode() == IN)
+			p->unlink();
+	model._retired = true;
+	_todo.erase(&model);
+	_last.erase(&model);
+	if(model._prev != nullptr || model._next != nullptr) {
+		for(size_t i = 0; i < _chains.size(); i++)
+			if(find(_chains[i].begin(), _chains[i].end(), &model) != _chains[i].end()) {
+				_chains.erase(_chains.begin() + i);
+				break;
+			}
+		if(model._prev != nullptr)
+			model._prev->_next = nullptr;
+		if(model._next != nullptr)
+			model._next->_prev = nullptr;
+		model._prev = model._next = nullptr;
+	}
+}
+
+
+/**
+ * Destroy the retired models that are no more scheduled and give back
+ * their storage to their pool.
+ */
+void Simulation::release() {
+	int j = 0;
+	for(auto m: _dead)
+		if(scheduled(*m) != 0)
+			_dead[j++] = m;
+		else if(m->_pool != nullptr) {
+			auto p = m->_pool;
+			auto a = dynamic_cast<void *>(m);
+			m->~Model();
+			p->release(a);
+		}
+	_dead.resize(j);
+}
+
+
+/*
+ * Give an ID to an object: the slot of a retired object is reused if
+ * any, a new slot is appended else.
+ * @param objects	Objects indexed by their ID.
+ * @param free		Free slots of objects.
+ * @param object	Object to index.
+ * @return			ID of the object.
+ */
+template <class T>
+static int allocate(vector<T *>& objects, vector<int>& free, T *object) {
+	if(free.empty()) {
+		objects.push_back(object);
+		return objects.size() - 1;
+	}
+	auto id = free.back();
+	free.pop_back();
+	objects[id] = object;
+	return id;
+}
+
+/*
+ * Assign dense IDs to a model, its values, its ports and its sub-models.
+ * The IDs of retired objects are reused. The path index is only rebuilt
+ * when a path is looked up (see @ref findModel()) so that activating a
+ * model does not build any string.
+ * @param model		Model to index.
+ */
+void Simulation::index(Model& model) {
+	model._id = allocate(_models, _free_models, &model);
+	for(auto v: model._vals)
+		v->_id = allocate(_values, _free_values, v);
+	for(auto p: model.ports())
+		p->_id = allocate(_ports, _free_ports, p);
+	if(model.isComposed())
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			index(*m);
+	_indexed = false;
+}
+
+/*
+ * Remove a retired model, its values, its ports and its sub-models from
+ * the index. Their slots are set to null and their IDs are given to the
+ * next indexed objects. The IDs are freed in the reverse order of
+ * @ref index() so that a model of the same layout gets the same IDs.
+ * @param model		Model to remove.
+ */
+void Simulation::unindex(Model& model) {
+	if(model.isComposed()) {
+		auto& subs = static_cast<ComposedModel&>(model).subModels();
+		for(auto i = subs.rbegin(); i != subs.rend(); ++i)
+			unindex(**i);
+	}
+	for(auto i = model.ports().rbegin(); i != model.ports().rend(); ++i) {
+		_ports[(*i)->_id] = nullptr;
+		_free_ports.push_back((*i)->_id);
+		(*i)->_id = -1;
+	}
+	for(auto i = model._vals.rbegin(); i != model._vals.rend(); ++i) {
+		_values[(*i)->_id] = nullptr;
+		_free_values.push_back((*i)->_id);
+		(*i)->_id = -1;
+	}
+	_models[model._id] = nullptr;
+	_free_models.push_back(model._id);
+	model._id = -1;
+	_indexed = false;
+}
+
+/*
+ * Build the path index if models have been activated or retired since
+ * it has been built.
+ */
+void Simulation::indexPaths() const {
+	if(_indexed)
+		return;
+	_model_index.clear();
+	_port_index.clear();
+	_value_index.clear();
+	for(size_t i = 0; i < _models.size(); i++)
+		if(_models[i] != nullptr)
+			_model_index[_models[i]->fullname()] = i;
+	for(size_t i = 0; i < _ports.size(); i++)
+		if(_ports[i] != nullptr)
+			_port_index[_ports[i]->fullname()] = i;
+	for(size_t i = 0; i < _values.size(); i++)
+		if(_values[i] != nullptr)
+			_value_index[_values[i]->fullname()] = i;
+	_indexed = true;
+}
+
+/**
+ * Find a model by its full name (dotted path from the top model).
+ * @param path	Full name of the model.
+ * @return		Found model or null.
+ */
+Model *Simulation::findModel(const string& path) const {
+	indexPaths();
+	auto i = _model_index.find(path);
+	return i == _model_index.end() ? nullptr : _models[i->second];
+}
+
+/**
+ * Find a port by its full name (dotted path from the top model).
+ * @param path	Full name of the port.
+ * @return		Found port or null.
+ */
+AbstractPort *Simulation::findPort(const string& path) const {
+	indexPaths();
+	auto i = _port_index.find(path);
+	return i == _port_index.end() ? nullptr : _ports[i->second];
+}
+
+/**
+ * Find a parameter or a state value by its full name (dotted path from
+ * the top model).
+ * @param path	Full name of the value.
+ * @return		Found value or null.
+ */
+AbstractValue *Simulation::findValue(const string& path) const {
+	indexPaths();
+	auto i = _value_index.find(path);
+	return i == _value_index.end() ? nullptr : _values[i->second];
+}
+
+/**
+ * @fn const vector<Model *>& Simulation::models() const;
+ * Get the models of the simulation indexed by their ID (see @ref Model::id()).
+ * The slots of retired models are null until they are reused.
+ * @return	Models of the simulation.
+ */
+
+/**
+ * @fn const vector<AbstractPort *>& Simulation::ports() const;
+ * Get the ports of the simulation indexed by their ID
+ * (see @ref AbstractPort::id()). The slots of retired ports are null
+ * until they are reused.
+ * @return	Ports of the simulation.
+ */
+
+/**
+ * @fn const vector<AbstractValue *>& Simulation::values() const;
+ * Get the parameters and state values of the simulation indexed by their
+ * ID (see @ref AbstractValue::id()). The slots of retired values are
+ * null until they are reused.
+ * @return	Values of the simulation.
+ */
+
+/**
+ * @fn Model *Simulation::model(int id) const;
+ * Get a model by its ID.
+ * @param id	Model ID.
+ * @return		Model (null if it has been retired).
+ */
+
+/**
+ * @fn AbstractPort *Simulation::port(int id) const;
+ * Get a port by its ID.
+ * @param id	Port ID.
+ * @return		Port (null if it has been retired).
+ */
+
+/**
+ * @fn AbstractValue *Simulation::value(int id) const;
+ * Get a value by its ID.
+ * @param id	Value ID.
+ * @return		Value (null if it has been retired).
+ */
+
+
+/**
+ * @fn M *Simulation::create(A&&... args);
+ * Create a model of type M during the simulation. The model storage
+ * is taken from a pool dedicated to M and the model is built by passing
+ * the given arguments to the constructor of M. Once its input ports are
+ * connected, the model has to be activated with @ref activate().
+ * @param args	Arguments of the constructor of M.
+ * @return		Created model.
+ */
+
 /**
  * @fn date_t Simulation::date() const;
  * Get the current date.
@@ -246,15 +1049,31 @@ void Simulation::pause() {
 }
 
 /**
- * Stop the current simulation.
+ * Stop the current simulation. The pending schedules are dropped and
+ * the retired models waiting for them are destroyed.
  */
 void Simulation::stop() {
 	if(_state != STOPPED) {
 		_state = STOPPED;
 		_top.stop();
 		_todo.clear();
-		while(!_sched.empty())
-			_sched.pop();
+		for(auto m: _models)
+			if(m != nullptr)
+				m->_waiting.clear();
+		unschedule();
+		if(!_dead.empty())
+			release();
+	}
+}
+
+
+/*
+ * Remove all the pending schedules of the periodic models.
+ */
+void Simulation::unschedule() {
+	while(!_sched.empty()) {
+		_sched.top().model->_scheds--;
+		_sched.pop();
 	}
 }
 
@@ -273,10 +1092,20 @@ void Simulation::stop() {
 
 /**
  * @fn bool Simulation::tracing() const;
- * Get the state of the tracing method.
+ * Get the state of the tracing method. If PHYSIM_NO_TRACE is defined
+ * (CMake option NO_TRACE), the tracing is compiled out and this function
+ * always returns false.
  * @return	True if tracing is on, false else.
  */
 
+/**
+ * @fn bool Simulation::textTracing() const;
+ * Test if the tracing is displayed as text, that is, if tracing is on
+ * and no recorder is attached (see @ref setRecorder()). The messages that
+ * have no recorded form are only displayed in this case.
+ * @return	True if tracing is displayed as text, false else.
+ */
+
 /**
  * @fn void Simulation::setTracing(bool t);
  * Set the tracing option.
@@ -36,8 +36,8 @@ namespace physim {
  * @param size		Value size (for arrays).
  * @param flavor	Value flavor.
  */
-AbstractValue::AbstractValue(Model *parent, string name, Type& type, int size, flavor_t flavor)
-	: _parent(parent), _name(name), _type(type), _size(size), _flavor(flavor)
+AbstractValue::AbstractValue(Model *parent, string name, const Type& type, int size, flavor_t flavor)
+	: _parent(parent), _name(name), _type(type), _size(size), _flavor(flavor), _id(-1)
 {
 	parent->add(this);
 }
@@ -102,7 +102,7 @@ void AbstractValue::init() {
  */
 
 /**
- * @fn Type& AbstractValue::type() const;
+ * @fn const Type& AbstractValue::type() const;
  * Get the type of the value.
  * @return	Value type.
  */
@@ -113,6 +113,33 @@ void AbstractValue::init() {
  * @return	Value flavor.
  */
 
+/**
+ * @fn int AbstractValue::id() const;
+ * Get the dense ID of the value, assigned when the simulation is built
+ * (see @ref Simulation::values()).
+ * @return	Value ID (-1 before the simulation is built or once retired).
+ */
+
+/**
+ * Combine the current value into a hash value (used to detect
+ * steady states of the simulation). The default implementation
+ * returns the hash unchanged.
+ * @param h		Hash to combine with.
+ * @return		Combined hash.
+ */
+unsigned long long AbstractValue::hash(unsigned long long h) {
+	return h;
+}
+
+/**
+ * Append the current value to a snapshot of the simulation state (used
+ * to confirm steady states found by @ref hash()). The default
+ * implementation appends nothing.
+ * @param s		Snapshot to append to.
+ */
+void AbstractValue::snapshot(string& s) {
+}
+
 /**
  * Get full-qualified name of the value, that is, its name prefixed
  * by the hierarchy of models containing it.
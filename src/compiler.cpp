@@ -0,0 +1,241 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+
+#include <algorithm>
+#include <typeinfo>
+#ifdef __GNUC__
+#	include <cxxabi.h>
+#	include <cstdlib>
+#endif
+#include <physim/compiler.h>
+
+namespace physim {
+
+/**
+ * @class Compiled
+ * Entry points used by the code generated by @ref NetworkCompiler to drive
+ * a finalized simulation without passing through the scheduler.
+ */
+
+/**
+ * @fn void Compiled::start(Simulation& sim);
+ * Start the simulation (models are started, initialized and published)
+ * and drop the schedules of the periodic models as they are updated by
+ * the static schedule.
+ * @param sim	Started simulation.
+ */
+
+/**
+ * @fn void Compiled::update(PeriodicModel& model, date_t date);
+ * Update directly a periodic model without re-scheduling it.
+ * @param model	Updated model.
+ * @param date	Current date.
+ */
+
+/**
+ * @fn void Compiled::publish(Model& model);
+ * Publish the outputs of a model.
+ * @param model	Model to publish.
+ */
+
+/**
+ * @fn void Compiled::settle(Simulation& sim);
+ * Update the triggered reactive models and go to the next date.
+ * @param sim	Current simulation.
+ */
+
+
+/**
+ * @class NetworkCompiler
+ * Once a simulation is finalized, the model network is fixed. This class
+ * can then dump the network and generate a standalone C++ source replacing
+ * the scheduling of periodic models by a static schedule.
+ *
+ * Only the schedule of periodic models is static: they are updated and
+ * published in a fixed order at their dates, without the priority queue.
+ * The models are still called through their virtual update() and publish()
+ * (their bodies are protected user code) and the reactive models are still
+ * triggered through the port links and updated by the simulator, that
+ * already runs the fused chains (see @ref Simulation::chains()) without
+ * passing through its pending set. The values stay in the ports.
+ *
+ * The generated source includes the header given by the macro
+ * PHYSIM_APP_HEADER that must declare the application model (a source
+ * file using @ref PHYSIM_RUN can be used as PHYSIM_COMPILED is defined
+ * before the inclusion). The generated main() accepts an optional duration
+ * argument.
+ *
+ * This tool is available from applications based on @ref Simulate with
+ * options --dump-graph and --compile.
+ */
+
+/**
+ * Build a network compiler.
+ * @param sim	Finalized simulation.
+ */
+NetworkCompiler::NetworkCompiler(Simulation& sim): _sim(sim) {
+	collect(sim.top());
+}
+
+/**
+ * Collect the leaf models.
+ * @param model	Current model.
+ */
+void NetworkCompiler::collect(Model& model) {
+	if(!model.isComposed()) {
+		_index[&model] = _models.size();
+		_models.push_back(&model);
+	}
+	else
+		for(auto m: static_cast<ComposedModel&>(model).subModels())
+			collect(*m);
+}
+
+/**
+ * Compute the kind of a model.
+ * @param model	Model to look at.
+ * @return		Model kind.
+ */
+NetworkCompiler::kind_t NetworkCompiler::kindOf(Model *model) {
+	if(dynamic_cast<PeriodicModel *>(model) != nullptr)
+		return PERIODIC;
+	else if(dynamic_cast<ReactiveModel *>(model) != nullptr)
+		return REACTIVE;
+	else
+		return OTHER;
+}
+
+/**
+ * Dump the model network in textual form.
+ * @param out	Output stream.
+ */
+void NetworkCompiler::dump(ostream& out) {
+	for(auto m: _models) {
+		out << "model " << m->fullname();
+		switch(kindOf(m)) {
+		case PERIODIC:	out << " periodic " << static_cast<PeriodicModel *>(m)->period(); break;
+		case REACTIVE:	out << " reactive"; break;
+		case OTHER:		out << " other"; break;
+		}
+		out << endl;
+		for(auto p: m->ports())
+			if(p->mode() == IN) {
+				out << "\tin " << p->name() << '[' << p->size() << ']';
+				auto s = p->source();
+				if(s != nullptr)
+					out << " <- " << s->fullname();
+				out << endl;
+			}
+			else
+				out << "\tout " << p->name() << '[' << p->size() << ']' << endl;
+	}
+	for(const auto& c: _sim.chains()) {
+		out << "chain " << c[0]->fullname();
+		for(size_t i = 1; i < c.size(); i++)
+			out << " -> " << c[i]->fullname();
+		out << endl;
+	}
+}
+
+/**
+ * Generate a C++ source running the model network with a static schedule:
+ * the periodic models are directly updated and published at their dates
+ * while the reactive models are updated by the simulator.
+ * @param out		Output stream.
+ * @param duration	Default duration of the simulation.
+ */
+void NetworkCompiler::generate(ostream& out, duration_t duration) {
+
+	// get the application class
+	string app = typeid(_sim.top()).name();
+#	ifdef __GNUC__
+		int status;
+		auto name = abi::__cxa_demangle(app.c_str(), nullptr, nullptr, &status);
+		if(status == 0) {
+			app = name;
+			free(name);
+		}
+#	endif
+
+	// group periodic models by period
+	map<duration_t, vector<int> > pers;
+	for(size_t i = 0; i < _models.size(); i++)
+		if(kindOf(_models[i]) == PERIODIC)
+			pers[static_cast<PeriodicModel *>(_models[i])->period()].push_back(i);
+
+	// prolog
+	out << "// Generated by PhySim from " << _sim.top().fullname() << ": do not edit!" << endl
+		<< "#define PHYSIM_COMPILED" << endl
+		<< "#ifndef PHYSIM_APP_HEADER" << endl
+		<< "#\terror \"PHYSIM_APP_HEADER must be defined to the header declaring " << app << "\"" << endl
+		<< "#endif" << endl
+		<< "#include PHYSIM_APP_HEADER" << endl
+		<< "#include <cstdlib>" << endl
+		<< endl
+		<< "int main(int argc, char **argv) {" << endl
+		<< "\tusing namespace physim;" << endl
+		<< "\t" << app << " app;" << endl
+		<< "\tSimulation sim(app);" << endl
+		<< endl;
+
+	// model table
+	out << "\tstatic const char *paths[] = {" << endl;
+	for(auto m: _models)
+		out << "\t\t\"" << m->fullname() << "\"," << endl;
+	out << "\t};" << endl
+		<< "\tModel *m[" << _models.size() << "];" << endl
+		<< "\tfor(int i = 0; i < " << _models.size() << "; i++) {" << endl
+		<< "\t\tm[i] = sim.findModel(paths[i]);" << endl
+		<< "\t\tif(m[i] == nullptr) {" << endl
+		<< "\t\t\tsim.monitor().error(string(\"cannot find model \") + paths[i]);" << endl
+		<< "\t\t\treturn 1;" << endl
+		<< "\t\t}" << endl
+		<< "\t}" << endl
+		<< endl;
+
+	// static schedule
+	out << "\tdate_t d = argc > 1 ? strtoull(argv[1], nullptr, 10) : " << duration << ";" << endl
+		<< "\tCompiled::start(sim);" << endl
+		<< "\twhile(!sim.isStopped() && sim.date() < d) {" << endl
+		<< "\t\tauto date = sim.date();" << endl;
+	if(!pers.empty()) {
+		out << "\t\tif(date != 0) {" << endl;
+		for(const auto& p: pers) {
+			out << "\t\t\tif(date % " << p.first << " == 0) {" << endl;
+			for(auto i: p.second)
+				out << "\t\t\t\tCompiled::update(*static_cast<PeriodicModel *>(m[" << i << "]), date);\t// " << _models[i]->fullname() << endl;
+			out << "\t\t\t}" << endl;
+		}
+		for(const auto& p: pers) {
+			out << "\t\t\tif(date % " << p.first << " == 0) {" << endl;
+			for(auto i: p.second)
+				out << "\t\t\t\tCompiled::publish(*m[" << i << "]);" << endl;
+			out << "\t\t\t}" << endl;
+		}
+		out << "\t\t}" << endl;
+	}
+	out << "\t\tCompiled::settle(sim);" << endl
+		<< "\t}" << endl
+		<< "\tsim.stop();" << endl
+		<< "\treturn 0;" << endl
+		<< "}" << endl;
+}
+
+} // physim
@@ -0,0 +1,44 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+
+#include <fstream>
+#include <physim/trace.h>
+using namespace physim;
+
+/*
+ * Decode a binary trace recorded by TraceRecorder (--trace-file option)
+ * into the text format of the tracing.
+ */
+int main(int argc, char **argv) {
+	if(argc != 2) {
+		cerr << "SYNTAX: physim-trace TRACE_FILE" << endl;
+		return 1;
+	}
+	ifstream in(argv[1], ios::binary);
+	if(in.fail()) {
+		cerr << "ERROR: cannot open " << argv[1] << endl;
+		return 1;
+	}
+	if(!TraceRecorder::decode(in, cout)) {
+		cerr << "ERROR: truncated trace file " << argv[1] << endl;
+		return 1;
+	}
+	return 0;
+}
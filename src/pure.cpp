@@ -0,0 +1,183 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+
+#include <physim/pure.h>
+
+namespace physim {
+
+/**
+ * @class PureModel
+ * A pure model is a reactive model whose outputs only depend on the
+ * current value of its inputs. For such a model, the output values
+ * are cached according to the input values and, when the input values
+ * are found in the cache, the outputs are restored from the cache without
+ * calling @ref compute().
+ *
+ * The memoized ports must be declared with @ref memoize() in the constructor
+ * of the model and their type must be trivially copyable. The cache is
+ * bounded: when it is full, the least recently used entry is dropped.
+ *
+ * @code
+ * class Steam: public PureModel {
+ * public:
+ * 	InputPort<double> p, t;
+ * 	OutputPort<double> h;
+ * 	Steam(string name, ComposedModel *parent)
+ * 		: PureModel(name, parent), p(this, "p"), t(this, "t"), h(this, "h")
+ * 		{ memoize(p); memoize(t); memoize(h); }
+ * protected:
+ * 	void compute() override { h = enthalpy(p, t); }
+ * };
+ * @endcode
+ */
+
+/**
+ * Default hash function (FNV-1a).
+ * @param data	Data to hash.
+ * @param size	Size in bytes of the data.
+ * @return		Hash value.
+ */
+size_t PureModel::fnv(const void *data, size_t size) {
+	return hash_bytes(data, size);
+}
+
+/**
+ * Build a pure model.
+ * @param name		Model name.
+ * @param parent	Parent model.
+ * @param size		Maximum number of entries of the cache (default 64).
+ */
+PureModel::PureModel(string name, ComposedModel *parent, size_t size)
+	: ReactiveModel(name, parent), _size(size), _hits(0), _misses(0) { }
+
+/**
+ * Change the maximum number of entries of the cache. A size of 0
+ * disables the cache.
+ * @param size	New cache size.
+ */
+void PureModel::setCacheSize(size_t size) {
+	_size = size;
+	while(_lru.size() > _size) {
+		_map.erase(_lru.back().first);
+		_lru.pop_back();
+	}
+}
+
+/**
+ * Change the hash function used to look up the input values.
+ * This flushes the cache.
+ * @param hash	New hash function.
+ */
+void PureModel::setHash(hash_t hash) {
+	flush();
+	_map = map_t(16, Hash(hash));
+}
+
+/**
+ * Remove all entries of the cache. The hit and miss counters are
+ * not reset.
+ */
+void PureModel::flush() {
+	_map.clear();
+	_lru.clear();
+}
+
+/**
+ * @fn size_t PureModel::cacheSize() const;
+ * Get the maximum number of entries of the cache.
+ * @return	Cache size.
+ */
+
+/**
+ * @fn unsigned long long PureModel::hits() const;
+ * Get the number of updates served by the cache.
+ * @return	Hit count.
+ */
+
+/**
+ * @fn unsigned long long PureModel::misses() const;
+ * Get the number of updates that required a call to @ref compute().
+ * @return	Miss count.
+ */
+
+/**
+ * @fn void PureModel::compute();
+ * Function to overload to compute the outputs of the model from its inputs.
+ * It is only called when the input values are not found in the cache.
+ */
+
+/**
+ * @fn void PureModel::memoize(InputPort<T, N>& port);
+ * Declare an input port as part of the cache key.
+ * @param port	Memoized input port.
+ */
+
+/**
+ * @fn void PureModel::memoize(OutputPort<T, N>& port);
+ * Declare an output port as part of the cached values.
+ * @param port	Memoized output port.
+ */
+
+///
+void PureModel::update() {
+	if(_size == 0) {
+		compute();
+		return;
+	}
+
+	// build the key
+	_key.clear();
+	for(const auto& s: _ins) {
+		auto d = s.data(s.port);
+		if(d == nullptr) {
+			compute();
+			return;
+		}
+		_key.append(static_cast<const char *>(d), s.size);
+	}
+
+	// cache hit
+	auto i = _map.find(_key);
+	if(i != _map.end()) {
+		_hits++;
+		_lru.splice(_lru.begin(), _lru, i->second);
+		auto v = i->second->second.data();
+		for(const auto& s: _outs) {
+			s.restore(s.port, v);
+			v += s.size;
+		}
+		return;
+	}
+
+	// cache miss
+	_misses++;
+	compute();
+	string v;
+	for(const auto& s: _outs)
+		v.append(static_cast<const char *>(s.data(s.port)), s.size);
+	_lru.push_front(make_pair(_key, v));
+	_map[_key] = _lru.begin();
+	if(_lru.size() > _size) {
+		_map.erase(_lru.back().first);
+		_lru.pop_back();
+	}
+}
+
+} // physim
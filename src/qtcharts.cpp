@@ -53,17 +53,17 @@ string cropped_name(string name) {
 
 class Stat {
 public:
-	Stat(AbstractPort *_port, int _i, QColor color)
-		: series(new QLineSeries()), port(_port), i(_i)
+	Stat(AbstractPort *_port, int _i, int _offset, QColor color)
+		: series(new QLineSeries()), port(_port), i(_i), offset(_offset)
 	{
 		series->setColor(color);
 		series->setName(cropped_name(port->fullname()).c_str());
 	}
 	QLineSeries *series;
 	AbstractPort *port;
-	int i;
-	void record(date_t date) {
-		 series->append(date, port->asReal(i));
+	int i, offset;
+	void record(date_t date, const vector<double>& vals) {
+		 series->append(date, vals[offset]);
 	}
 };
 
@@ -456,22 +456,33 @@ void QtSimulateWindow::do_run() {
 		delete s;
 	stats.clear();
 
-	// prepare the data
+	// prepare the data (the selected ports are gathered at once)
 	int color = 0;
+	vector<AbstractPort *> ports;
+	map<AbstractPort *, int> offsets;
+	int size = 0;
 	for(auto p: selector.ports()) {
-		stats.push_back(new Stat(p.first, p.second, colors[color]));
+		if(offsets.find(p.first) == offsets.end()) {
+			offsets[p.first] = size;
+			ports.push_back(p.first);
+			size += p.first->size();
+		}
+		stats.push_back(new Stat(p.first, p.second, offsets[p.first] + p.second, colors[color]));
 		color = (color + 1) % color_count;
 	}
+	vector<double> vals(size);
 
 	// generate the graph
 	sim->stop();
 	sim->start();
+	AbstractPort::gather(ports, vals.data());
 	for(auto s: stats)
-		s->record(sim->date());
+		s->record(sim->date(), vals);
 	while(sim->date() <= duration) {
 		sim->step();
+		AbstractPort::gather(ports, vals.data());
 		for(auto s: stats)
-			s->record(sim->date());
+			s->record(sim->date(), vals);
 	}
 
 	// display the graph
@@ -536,7 +547,7 @@ QtLineDisplay::AbstractReporter::AbstractReporter(QtLineDisplay *d) {
  * @param parent	Parent model.
  */
 QtLineDisplay::QtLineDisplay(string name, ComposedModel *parent)
-	: Model(name, parent), _color(0)
+	: Model(name, parent), _pending(false), _color(0)
 	{ }
 
 ///
@@ -554,11 +565,15 @@ QtLineDisplay::~QtLineDisplay() {
 
 ///
 void QtLineDisplay::start() {
-
+	_pending = false;
+	for(auto r: _reps)
+		r->attach();
 }
 
 ///
 void QtLineDisplay::stop() {
+	for(auto r: _reps)
+		r->detach();
 	Application app;
 
 	// build the chart
@@ -582,15 +597,12 @@ void QtLineDisplay::stop() {
 
 ///
 void QtLineDisplay::update() {
+	_pending = false;
 	_dates.push_back(date());
 	for(auto r: _reps)
 		r->record();
 }
 
-void QtLineDisplay::propagate(const AbstractPort& port) {
-	sim().triggerLast(*this);
-}
-
 /**
  * @fn QtSimulate;
  * Class defining a main program simulation running a Qt window
@@ -19,6 +19,7 @@
  */
 
 #include <fstream>
+#include <sstream>
 #include <physim/std.h>
 
 namespace physim {
@@ -76,7 +77,10 @@ namespace physim {
  * Generator of report.
  *
  * This class can connect several output port and to report the port values
- * changes along time.
+ * changes along time. The ports are observed (see OutputPort::observe()):
+ * a change only copies the new values in the report that is triggered
+ * once per date to output its row. The values of the ports when the
+ * report starts are output in the first row.
  *
  * Its output may be performed on any stream or to
  * a file and follows the CSV format. The first line contains the name of
@@ -91,7 +95,7 @@ namespace physim {
  * @param out		Output stream (default to cout).
  */
 Report::Report(string name, ComposedModel *parent, ostream& out):
-	Model(name, parent), _out(&out) { }
+	Model(name, parent), _pending(false), _out(&out) { }
 
 /**
  * Constructor of a report to a named file.
@@ -100,7 +104,7 @@ Report::Report(string name, ComposedModel *parent, ostream& out):
  * @param path		Path of the file to report to.
  */
 Report::Report(string name, ComposedModel *parent, string path):
-	Model(name, parent), _out(nullptr), _path(path) { }
+	Model(name, parent), _pending(false), _out(nullptr), _path(path) { }
 
 ///
 Report::~Report() {
@@ -125,10 +129,15 @@ void Report::start() {
 	for(auto r: _reps)
 		(*_out) << '\t' << r->name();
 	(*_out) << endl;
+	_pending = false;
+	for(auto r: _reps)
+		r->attach();
 }
 
 ///
 void Report::stop() {
+	for(auto r: _reps)
+		r->detach();
 	if(_path != "") {
 		delete _out;
 		_out = nullptr;
@@ -137,17 +146,35 @@ void Report::stop() {
 
 ///
 void Report::update() {
-	(*_out) << date();
-	for(auto r: _reps) {
-		(*_out) << '\t';
-		r->print(*_out);
+	_pending = false;
+	if(!sim().fastForwarding()) {
+		(*_out) << date();
+		for(auto r: _reps) {
+			(*_out) << '\t';
+			r->print(*_out);
+		}
+		(*_out) << endl;
+	}
+	else {
+		ostringstream row;
+		for(auto r: _reps) {
+			row << '\t';
+			r->print(row);
+		}
+		(*_out) << date() << row.str() << endl;
+		while(!_rows.empty() && _rows.front().first < sim().horizon())
+			_rows.pop_front();
+		_rows.push_back(make_pair(date(), row.str()));
 	}
-	(*_out) << endl;
 }
 
 ///
-void Report::propagate(const AbstractPort& port) {
-	sim().triggerLast(*this);
+void Report::fastForward(date_t from, duration_t cycle, date_t count) {
+	for(date_t i = 1; i <= count; i++)
+		for(const auto& r: _rows)
+			if(r.first >= from && r.first < from + cycle)
+				(*_out) << (r.first + i * cycle) << r.second << endl;
+	_rows.clear();
 }
 
 } // physim
@@ -95,6 +95,14 @@ void ReactiveTest::step() {
  * @param i		Index in the port of the value to test.
  */
 
+/**
+ * @fn void ReactiveTest::check(bool cond, const string& msg);
+ * Check that the given condition holds. If not, display the message
+ * and record the error.
+ * @param cond	Condition to check.
+ * @param msg	Message to display in case of failure.
+ */
+
 
 /**
  * @class PeriodicTest
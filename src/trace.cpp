@@ -0,0 +1,251 @@
+/*
+ * PhySim library -- DEVS for physics
+ * Copyright (C) 2020  Hugues Cassé <hug.casse@gmail.com>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ *  USA
+ */
+
+#include <chrono>
+#include <map>
+#include <physim/trace.h>
+
+namespace physim {
+
+/**
+ * @class TraceRecorder
+ * Binary recorder of the simulation trace. The events (port writes,
+ * model updates, triggers and initializations) are stored as fixed-size
+ * records in lock-free ring buffers, one per recording thread, and a
+ * background thread drains them into a file. The models and ports are
+ * identified by their address, associated with their full name by
+ * @ref name() records.
+ *
+ * The produced file is turned back into the text format of the tracing
+ * with @ref decode() or the physim-trace tool. Values whose type is not
+ * a scalar are displayed as "?".
+ *
+ * To record the trace of a simulation, pass the recorder to
+ * @ref Simulation::setRecorder() or use the --trace-file option of
+ * the applications.
+ */
+
+thread_local TraceRecorder *TraceRecorder::_owner = nullptr;
+thread_local TraceRecorder::Ring *TraceRecorder::_ring = nullptr;
+
+/*
+ * Build a ring buffer.
+ * @param capacity	Capacity (power of 2).
+ */
+TraceRecorder::Ring::Ring(int capacity):
+	events(capacity), mask(capacity - 1), head(0), tail(0)
+	{ }
+
+/**
+ * Build a trace recorder writing to the given file.
+ * @param path		Path of the trace file.
+ * @param capacity	Number of events in each ring buffer (rounded up to
+ * 					a power of 2).
+ */
+TraceRecorder::TraceRecorder(const string& path, int capacity):
+	_file(fopen(path.c_str(), "wb")),
+	_capacity(1),
+	_done(false)
+{
+	while(_capacity < capacity)
+		_capacity <<= 1;
+	if(_file != nullptr)
+		_thread = thread(&TraceRecorder::run, this);
+}
+
+/**
+ * Stop the drain thread, write the remaining events and close the file.
+ */
+TraceRecorder::~TraceRecorder() {
+	if(_file != nullptr) {
+		_done = true;
+		_thread.join();
+		fclose(_file);
+	}
+	for(auto r: _rings)
+		delete r;
+	if(_owner == this) {
+		_owner = nullptr;
+		_ring = nullptr;
+	}
+}
+
+/**
+ * @fn bool TraceRecorder::isOpen() const;
+ * Test if the trace file has been successfully opened.
+ * @return	True if the recorder is working, false else.
+ */
+
+/**
+ * Record the name of an object (model or port) of the simulation.
+ * @param object	Recorded object.
+ * @param name		Full name of the object.
+ * @param size		Number of values of a port.
+ */
+void TraceRecorder::name(const void *object, const string& name, int size) {
+	Event e = { 0, uint64_t(reinterpret_cast<uintptr_t>(object)), name.size(), uint32_t(size), NAME, NONE };
+	push(e);
+	for(size_t i = 0; i < name.size(); i += sizeof(Event)) {
+		memset(&e, 0, sizeof(Event));
+		memcpy(&e, name.data() + i, min(sizeof(Event), name.size() - i));
+		push(e);
+	}
+}
+
+/**
+ * @fn void TraceRecorder::record(kind_t kind, date_t date, const void *object, uint64_t bits, uint32_t index);
+ * Record an event about a model or a port. The meaning of bits and index
+ * depends on the kind:
+ * @li RESUME -- bits is the date the model is resumed at,
+ * @li RECONNECT -- bits is the address of the new source port,
+ * @li WATCH -- index is the action_t requested by the watch,
+ * @li STEADY -- bits is the number of fast-forwarded cycles and index
+ * the duration of a cycle.
+ * @param kind		Kind of event.
+ * @param date		Date of the event.
+ * @param object	Concerned model or port.
+ * @param bits		Event argument (default to 0).
+ * @param index		Event argument (default to 0).
+ */
+
+/**
+ * @fn void TraceRecorder::record(date_t date, const void *port, int index, const T& x);
+ * Record the write of a value in a port.
+ * @param date		Date of the event.
+ * @param port		Written port.
+ * @param index		Index of the written value.
+ * @param x			Written value.
+ */
+
+/*
+ * Allocate a ring buffer for the current thread.
+ */
+void TraceRecorder::attach() {
+	lock_guard<mutex> guard(_lock);
+	_ring = new Ring(_capacity);
+	_rings.push_back(_ring);
+	_owner = this;
+}
+
+/*
+ * Write to the file the events available in the ring buffers.
+ * @return	True if some events have been written, false else.
+ */
+bool TraceRecorder::drain() {
+	bool written = false;
+	lock_guard<mutex> guard(_lock);
+	for(auto r: _rings) {
+		auto t = r->tail.load(memory_order_relaxed);
+		auto h = r->head.load(memory_order_acquire);
+		while(t != h) {
+			auto i = t & r->mask;
+			auto n = min(h - t, r->events.size() - i);
+			fwrite(&r->events[i], sizeof(Event), n, _file);
+			t += n;
+			r->tail.store(t, memory_order_release);
+			written = true;
+		}
+	}
+	return written;
+}
+
+/*
+ * Body of the drain thread.
+ */
+void TraceRecorder::run() {
+	while(!_done)
+		if(!drain())
+			this_thread::sleep_for(chrono::milliseconds(1));
+	drain();
+}
+
+/**
+ * Decode a binary trace into the text format of the tracing.
+ * @param in	Stream to read the binary trace from.
+ * @param out	Stream to write the text trace to.
+ * @return		True if the trace has been decoded, false if it is truncated.
+ */
+bool TraceRecorder::decode(istream& in, ostream& out) {
+	map<uint64_t, pair<string, int> > names;
+	Event e;
+	while(in.read(reinterpret_cast<char *>(&e), sizeof(Event))) {
+		if(e.kind == NAME) {
+			string name(e.bits, ' ');
+			for(size_t i = 0; i < name.size(); i += sizeof(Event)) {
+				Event c;
+				if(!in.read(reinterpret_cast<char *>(&c), sizeof(Event)))
+					return false;
+				memcpy(&name[i], &c, min(sizeof(Event), name.size() - i));
+			}
+			names[e.object] = make_pair(name, int(e.index));
+			continue;
+		}
+		string name = "?", other = "?";
+		int size = 1;
+		auto i = names.find(e.object);
+		if(i != names.end()) {
+			name = i->second.first;
+			size = i->second.second;
+		}
+		if(e.kind == RECONNECT) {
+			i = names.find(e.bits);
+			if(i != names.end())
+				other = i->second.first;
+		}
+		out << "TRACE: " << e.date << ": ";
+		switch(e.kind) {
+		case WRITE:
+			out << "port " << name;
+			if(size != 1)
+				out << "[" << e.index << "]";
+			out << " receives ";
+			switch(e.encoding) {
+			case SIGNED:	out << int64_t(e.bits); break;
+			case UNSIGNED:	out << e.bits; break;
+			case FLOAT:		{ float x; memcpy(&x, &e.bits, sizeof(x)); out << x; } break;
+			case DOUBLE:	{ double x; memcpy(&x, &e.bits, sizeof(x)); out << x; } break;
+			case BOOL:		out << (e.bits != 0); break;
+			case CHAR:		out << char(e.bits); break;
+			default:		out << "?"; break;
+			}
+			break;
+		case UPDATE:	out << "updating " << name; break;
+		case TRIGGER:	out << "trigger " << name; break;
+		case INIT:		out << "init " << name; break;
+		case ACTIVATE:	out << "activating " << name; break;
+		case RETIRE:	out << "retiring " << name; break;
+		case PARK:		out << "parking " << name; break;
+		case RESUME:	out << "resuming " << name << " at " << e.bits; break;
+		case RECONNECT:	out << name << " reconnected to " << other; break;
+		case WATCH:
+			out << "watch on " << name << (e.index == STOP ? " stops" : " pauses") << " the simulation";
+			break;
+		case STEADY:
+			out << "steady state since " << e.date - e.index
+				<< ", fast-forwarding " << e.bits << " cycle(s) of " << e.index;
+			break;
+		default:		out << "unknown event " << e.kind; break;
+		}
+		out << endl;
+	}
+	return in.eof() && in.gcount() == 0;
+}
+
+}	// physim
@@ -0,0 +1,89 @@
+/*
+ * Port arena test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Inc: public PeriodicModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Inc(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void init() override { y = 0; }
+	void update(date_t at) override { y = x + 1; }
+};
+
+class Twice: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Twice(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = 2 * x; }
+};
+
+class Mix: public ReactiveModel {
+public:
+	OutputPort<double> a;
+	OutputPort<char> c;
+	OutputPort<double> b;
+
+	Mix(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		a(this, "a"),
+		c(this, "c"),
+		b(this, "b")
+	{ }
+protected:
+	void update() override { a = 1; c = 'c'; b = 2; }
+};
+
+class ArenaTest: public ReactiveTest {
+public:
+	Inc inc;
+	Twice twice;
+	Mix mix;
+	InputPort<int> y;
+
+	ArenaTest():
+		ReactiveTest("arena-test"),
+		inc("inc", this),
+		twice("twice", this),
+		mix("mix", this),
+		y(this, "y")
+	{
+		connect(inc.y, twice.x);
+		connect(twice.y, inc.x);
+		connect(twice.y, y);
+	}
+
+	void test() override {
+		auto i = reinterpret_cast<const char *>(inc.x.data());
+		auto t = reinterpret_cast<const char *>(twice.x.data());
+		check(i > t ? i - t < 64 : t - i < 64, "ports not packed");
+		check(mix.b.data() == mix.a.data() + 1, "ports not grouped by type");
+		check(inc.x.data() == twice.y.data(), "input not linked to arena");
+		check(y.data() == twice.y.data(), "input not linked to arena");
+		int e = 0;
+		for(int k = 0; k < 4; k++) {
+			step();
+			check(y, e);
+			e = 2 * (e + 1);
+		}
+	}
+};
+
+PHYSIM_RUN(ArenaTest)
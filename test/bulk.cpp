@@ -0,0 +1,87 @@
+/*
+ * Bulk array port write test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Sum: public ReactiveModel {
+public:
+	InputPort<int, 16> x;
+	OutputPort<int> y;
+	int touches;
+
+	Sum(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y"),
+		touches(0)
+	{ }
+protected:
+
+	void propagate(const AbstractPort& port) override {
+		touches++;
+		ReactiveModel::propagate(port);
+	}
+
+	void update() override {
+		int s = 0;
+		for(int i = 0; i < 16; i++)
+			s += x[i];
+		y = s;
+	}
+};
+
+class BulkTest: public ReactiveTest {
+public:
+	Sum s;
+	OutputPort<int, 16> x;
+	InputPort<int> y;
+
+	BulkTest():
+		ReactiveTest("bulk-test"),
+		s("sum", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, s.x);
+		connect(s.y, y);
+	}
+
+	void test() override {
+		int a[16];
+		for(int i = 0; i < 16; i++)
+			a[i] = i;
+		s.touches = 0;
+		x.assign(a);
+		step();
+		check(y, 120);
+		check(s.touches == 1, "bulk assignment touched several times");
+
+		x.assign(a);
+		step();
+		check(s.touches == 1, "unchanged assignment touched");
+
+		x.assign({ 5, 5, 5 });
+		step();
+		check(y, 132);
+		check(s.touches == 2, "partial assignment not touched once");
+
+		{
+			OutputPort<int, 16>::Batch b(x);
+			for(int i = 0; i < 16; i++)
+				x[i] = 2;
+		}
+		step();
+		check(y, 32);
+		check(s.touches == 3, "batch touched several times");
+
+		x.assign(vector<int>(8, 1), 12);
+		step();
+		check(y, 28);
+		check(s.touches == 4, "clamped assignment not touched once");
+	}
+};
+
+PHYSIM_RUN(BulkTest)
@@ -0,0 +1,179 @@
+/*
+ * Signal bus test
+ */
+
+#include <physim.h>
+#include <physim/bus.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Chassis: public Bus {
+public:
+	Signal<double> speed {this, "speed"};
+	Signal<double> yaw {this, "yaw"};
+	Signal<int> gear {this, "gear", 1};
+};
+
+class Wide: public Bus {
+public:
+	class Octet {
+	public:
+		Octet(Bus *b): v{{b, "v"}, {b, "v"}, {b, "v"}, {b, "v"}, {b, "v"}, {b, "v"}, {b, "v"}, {b, "v"}} { }
+		Signal<int> v[8];
+	};
+	Octet a {this}, b {this}, c {this}, d {this}, e {this}, f {this}, g {this}, h {this}, i {this};
+	Signal<int> last {this, "last"};
+};
+
+class Clock: public PeriodicModel {
+public:
+	BusOutputPort<Chassis> y;
+	BusOutputPort<Wide> w;
+	double seen;
+
+	Clock(string name, ComposedModel *parent):
+		PeriodicModel(name, 2, parent),
+		y(this, "y"),
+		w(this, "w"),
+		seen(-1)
+	{ }
+protected:
+
+	void update(date_t date) override {
+		y->speed = date;
+		seen = y.published().speed;
+		w->last = date;
+	}
+};
+
+class Logger: public ReactiveModel {
+public:
+	BusInputPort<Chassis> x;
+	BusInputPort<Wide> w;
+	int updates;
+	double speed;
+	bool aliased, last;
+
+	Logger(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		w(this, "w"),
+		updates(0),
+		speed(-1),
+		aliased(false),
+		last(false)
+	{ }
+protected:
+
+	void update() override {
+		updates++;
+		speed = x->speed;
+		aliased = w.changed(w->b.v[0]);
+		last = w.changed(w->last);
+	}
+};
+
+class Controller: public ReactiveModel {
+public:
+	InputPort<double> x;
+	BusOutputPort<Chassis> y;
+
+	Controller(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+
+	void update() override {
+		y->speed = x;
+		y->yaw = x / 10;
+		y->gear = x < 20 ? 1 : 2;
+	}
+};
+
+class Dashboard: public ReactiveModel {
+public:
+	BusInputPort<Chassis> x;
+	OutputPort<int> y;
+	int updates;
+	uint64_t changed;
+	bool gear;
+
+	Dashboard(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y"),
+		updates(0),
+		changed(0),
+		gear(false)
+	{ }
+protected:
+
+	void update() override {
+		updates++;
+		changed = x.changed().word(0);
+		gear = x.changed(x->gear);
+		y = int(x->speed) * 10 + x->gear;
+	}
+};
+
+class BusTest: public ReactiveTest {
+public:
+	Controller c;
+	Dashboard d;
+	Clock k;
+	Logger m;
+	OutputPort<double> x;
+	InputPort<int> y;
+
+	BusTest():
+		ReactiveTest("bus-test"),
+		c("controller", this),
+		d("dashboard", this),
+		k("clock", this),
+		m("logger", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, c.x);
+		connect(c.y, d.x);
+		connect(d.y, y);
+		connect(k.y, m.x);
+		connect(k.w, m.w);
+	}
+
+	void test() override {
+		check(c.y->size() == 3 && string(c.y->name(2)) == "gear", "bad bus signals");
+		x = 10;
+		step();
+		check(y, 101);
+		check(d.updates == 1, "bus propagated several times");
+		check(d.changed == 3, "bad changed mask");
+		check(!d.gear, "gear reported as changed");
+
+		x = 30;
+		step();
+		check(y, 302);
+		check(d.updates == 2, "bus propagated several times");
+		check(d.changed == 7, "bad changed mask");
+		check(d.gear, "gear not reported as changed");
+
+		x = 30;
+		step();
+		check(d.updates == 2, "unchanged bus propagated");
+
+		// delayed bus of a periodic model
+		check(k.w->size() == 73, "bad wide bus signals");
+		auto u = m.updates;
+		step();
+		check(m.updates == u, "periodic bus propagated out of its period");
+		step();
+		check(k.seen == 2, "periodic bus not delayed");
+		check(m.speed == 4, "periodic bus not published");
+		check(m.updates == u + 1, "periodic bus propagated several times");
+		check(m.last && !m.aliased, "bad changed mask beyond 64 signals");
+	}
+};
+
+PHYSIM_RUN(BusTest)
@@ -0,0 +1,7 @@
+/*
+ * Interpreted run of the network compiler test
+ */
+
+#include "compile_net.h"
+
+PHYSIM_RUN(CompileNet)
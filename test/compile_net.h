@@ -0,0 +1,90 @@
+/*
+ * Network used to test the network compiler: the models check themselves
+ * so that the interpreted and the compiled runs must give the same values.
+ */
+#ifndef TEST_COMPILE_NET_H_
+#define TEST_COMPILE_NET_H_
+
+#include <cstdlib>
+#include <physim.h>
+using namespace physim;
+
+class Ramp: public PeriodicModel {
+public:
+	OutputPort<int> y;
+
+	Ramp(string name, duration_t period, ComposedModel *parent):
+		PeriodicModel(name, period, parent),
+		y(this, "y")
+	{ }
+protected:
+	void update(date_t at) override { y = int(at); }
+};
+
+class Neg: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Neg(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = -x; }
+};
+
+class Checker: public ReactiveModel {
+public:
+	InputPort<int> a, b;
+
+	Checker(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		a(this, "a"),
+		b(this, "b"),
+		_updates(0)
+	{ }
+protected:
+	void update() override {
+		_updates++;
+		if(a != -int(date() / 2 * 2) || b != int(date() / 3 * 3)) {
+			err() << "failed: " << date() << ": bad values " << a << ", " << b << endl;
+			exit(1);
+		}
+	}
+	void stop() override {
+		// only generating code: nothing run
+		if(date() == 0)
+			return;
+		// dates 0, 2, 3, 4, 6, 8 and 9 in [0, 10)
+		if(_updates != 7) {
+			err() << "failed: " << _updates << " updates instead of 7" << endl;
+			exit(1);
+		}
+		err() << "Success !" << endl;
+	}
+private:
+	int _updates;
+};
+
+class CompileNet: public Simulate {
+public:
+	Ramp r2, r3;
+	Neg n;
+	Checker c;
+
+	CompileNet():
+		Simulate("compile-net", 10),
+		r2("r2", 2, this),
+		r3("r3", 3, this),
+		n("neg", this),
+		c("check", this)
+	{
+		connect(r2.y, n.x);
+		connect(n.y, c.a);
+		connect(r3.y, c.b);
+	}
+};
+
+#endif /* TEST_COMPILE_NET_H_ */
@@ -0,0 +1,57 @@
+/*
+ * Network compiler dump test
+ */
+
+#include <sstream>
+#include <physim/compiler.h>
+#include <physim/test.h>
+#include "compile_net.h"
+
+class CompilerTest: public ReactiveTest {
+public:
+	Ramp r2, r3;
+	Neg n;
+	InputPort<int> a, b;
+
+	CompilerTest():
+		ReactiveTest("compiler-test"),
+		r2("r2", 2, this),
+		r3("r3", 3, this),
+		n("neg", this),
+		a(this, "a"),
+		b(this, "b")
+	{
+		connect(r2.y, n.x);
+		connect(n.y, a);
+		connect(r3.y, b);
+	}
+
+	void test() override {
+		NetworkCompiler c(sim());
+
+		ostringstream dump;
+		c.dump(dump);
+		auto d = dump.str();
+		check(d.find("model compiler-test.r2 periodic 2\n") != string::npos, "periodic model not dumped");
+		check(d.find("model compiler-test.neg reactive\n") != string::npos, "reactive model not dumped");
+		check(d.find("\tin x[1] <- compiler-test.r2.y\n") != string::npos, "port source not dumped");
+
+		ostringstream gen;
+		c.generate(gen, 10);
+		auto g = gen.str();
+		check(g.find("if(date % 3 == 0) {\n\t\t\t\tCompiled::update(*static_cast<PeriodicModel *>(m[1]), date);") != string::npos,
+			"periodic model not scheduled");
+		check(g.find("sim.findModel(paths[i])") != string::npos, "models not bound by path");
+		check(g.find("Compiled::start(sim);") != string::npos, "periodic schedules not dropped");
+		check(g.find("sim.start()") == string::npos, "simulation scheduler started");
+
+		// the interpreted run gives the values checked by the compiled one
+		for(int k = 0; k < 10; k++) {
+			step();
+			check(a, -k / 2 * 2);
+			check(b, k / 3 * 3);
+		}
+	}
+};
+
+PHYSIM_RUN(CompilerTest)
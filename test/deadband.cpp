@@ -0,0 +1,73 @@
+/*
+ * Propagation policy test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Noisy: public PeriodicModel {
+public:
+	OutputPort<double> y, d, q;
+
+	Noisy(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		y(this, "y"),
+		d(this, "d"),
+		q(this, "q"),
+		k(0)
+	{
+		d.setDeadband(.5);
+		q.setQuantum(.25);
+	}
+protected:
+	void init() override { set(0); }
+	void update(date_t at) override { k++; set(k / 10 + (k % 2) * 1e-9); }
+private:
+	void set(double x) { y = x; d = x; q = x; }
+	int k;
+};
+
+class Counter: public ReactiveModel {
+public:
+	InputPort<double> x;
+	int count;
+
+	Counter(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		count(0)
+	{ }
+protected:
+	void update() override { count++; }
+};
+
+class DeadbandTest: public ReactiveTest {
+public:
+	Noisy n;
+	Counter cy, cd, cq;
+
+	DeadbandTest():
+		ReactiveTest("deadband-test"),
+		n("noisy", this),
+		cy("cy", this),
+		cd("cd", this),
+		cq("cq", this)
+	{
+		connect(n.y, cy.x);
+		connect(n.d, cd.x);
+		connect(n.q, cq.x);
+	}
+
+	void test() override {
+		for(int i = 0; i < 41; i++)
+			step();
+		check(cy.count == 41, "unfiltered port missed changes");
+		check(cd.count == 5, "deadband port propagated noise");
+		check(cq.count == 5, "quantized port propagated noise");
+		check(cd.x == 4., "bad deadband value");
+		check(cq.x == 4., "bad quantized value");
+	}
+};
+
+PHYSIM_RUN(DeadbandTest)
@@ -0,0 +1,87 @@
+/*
+ * Double-buffered periodic output test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Writer: public PeriodicModel {
+public:
+	OutputPort<int, 8> y;
+
+	Writer(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		y(this, "y"),
+		k(0)
+	{ }
+protected:
+	void init() override { for(int i = 0; i < 8; i++) y[i] = i; }
+	void update(date_t at) override { y[k % 8] = y[k % 8] + 10; k++; }
+private:
+	int k;
+};
+
+class Filler: public PeriodicModel {
+public:
+	OutputPort<int, 8> z, u;
+
+	Filler(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		z(this, "z"),
+		u(this, "u"),
+		k(0)
+	{ }
+protected:
+	void init() override { for(int i = 0; i < 8; i++) { z[i] = i; u[i] = i; } }
+	void update(date_t at) override {
+		int x[8];
+		for(int i = 0; i < 8; i++)
+			x[i] = z[i] + 1;
+		z.assign(x);
+		k++;
+		for(int i = 0; i < 8; i++)
+			x[i] = 8 * k + i;
+		u.assign(x);
+	}
+private:
+	int k;
+};
+
+class DoubleTest: public ReactiveTest {
+public:
+	Writer w;
+	Filler f;
+	InputPort<int, 8> y, z, u;
+
+	DoubleTest():
+		ReactiveTest("double-test"),
+		w("writer", this),
+		f("filler", this),
+		y(this, "y"),
+		z(this, "z"),
+		u(this, "u")
+	{
+		connect(w.y, y);
+		connect(f.z, z);
+		connect(f.u, u);
+	}
+
+	void test() override {
+		int e[8];
+		for(int i = 0; i < 8; i++)
+			e[i] = i;
+		for(int k = 0; k < 20; k++) {
+			for(int i = 0; i < 8; i++) {
+				check(y, e[i], i);
+				check(z, i + (k > 0 ? k - 1 : 0), i);
+				check(u, 8 * (k > 0 ? k - 1 : 0) + i, i);
+			}
+			step();
+			if(k > 0)
+				e[(k - 1) % 8] += 10;
+		}
+	}
+};
+
+PHYSIM_RUN(DoubleTest)
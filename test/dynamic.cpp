@@ -0,0 +1,91 @@
+/*
+ * Dynamic model creation test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Square: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> x2;
+
+	Square(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		x2(this, "x2")
+	{ }
+protected:
+
+	void update() override {
+		x2 = x * x;
+	}
+};
+
+class Ticker: public PeriodicModel {
+public:
+	OutputPort<int, 4> y;
+
+	Ticker(string name, ComposedModel *parent):
+		PeriodicModel(name, 10, parent),
+		y(this, "y")
+	{ }
+
+protected:
+
+	void update(date_t date) override {
+		y[0] = date;
+	}
+};
+
+class DynamicTest: public ReactiveTest {
+public:
+	OutputPort<int> x;
+
+	DynamicTest():
+		ReactiveTest("dynamic-test"),
+		x(this, "x")
+	{ }
+
+	Square *spawn(string name) {
+		auto s = sim().create<Square>(name, this);
+		connect(x, s->x);
+		sim().activate(*s);
+		return s;
+	}
+
+	void test() override {
+		auto s1 = spawn("s1");
+		x = 2;
+		step();
+		check(*s1->x2.data() == 4, "s1 not activated");
+		x = 3;
+		step();
+		check(*s1->x2.data() == 9, "s1 not updated");
+
+		sim().retire(*s1);
+		step();
+		check(subModels().empty(), "s1 not removed");
+		x = 4;
+		step();
+
+		auto s2 = spawn("s2");
+		check(s1 == s2, "storage of s1 not reused");
+		step();
+		check(*s2->x2.data() == 16, "s2 not activated");
+
+		// a periodic model retired with a pending schedule is released at stop
+		auto t1 = sim().create<Ticker>("t1", this);
+		sim().activate(*t1);
+		step();
+		sim().retire(*t1);
+		step();
+		sim().stop();
+		auto t2 = sim().create<Ticker>("t2", this);
+		check(t1 == t2, "storage of t1 not released at stop");
+		sim().activate(*t2);
+	}
+};
+
+PHYSIM_RUN(DynamicTest)
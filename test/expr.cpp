@@ -0,0 +1,70 @@
+/*
+ * Expression model test
+ */
+
+#include <physim.h>
+#include <physim/expr.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Mix: public ExprModel {
+public:
+	InputPort<int> x1, x2, x3;
+	Parameter<int, 1> k1, k2;
+	OutputPort<int> y, z;
+
+	Mix(string name, ComposedModel *parent):
+		ExprModel(name, parent),
+		x1(this, "x1"),
+		x2(this, "x2"),
+		x3(this, "x3"),
+		k1(this, "k1", 2),
+		k2(this, "k2", 3),
+		y(this, "y"),
+		z(this, "z")
+	{
+		define(y, expr(k1) * x1 + expr(k2) * x2 - x3);
+		define(z, -(expr(x1) - 10) / 2);
+	}
+};
+
+class ExprTest: public ReactiveTest {
+public:
+	Mix m;
+	OutputPort<int> x1, x2, x3;
+	InputPort<int> y, z;
+
+	ExprTest():
+		ReactiveTest("expr-test"),
+		m("mix", this),
+		x1(this, "x1"),
+		x2(this, "x2"),
+		x3(this, "x3"),
+		y(this, "y"),
+		z(this, "z")
+	{
+		connect(x1, m.x1);
+		connect(x2, m.x2);
+		connect(x3, m.x3);
+		connect(m.y, y);
+		connect(m.z, z);
+	}
+
+	void test() override {
+		x1 = 1;
+		x2 = 2;
+		x3 = 3;
+		step();
+		check(y, 5);
+		check(z, 4);
+		x3 = 0;
+		step();
+		check(y, 8);
+		x1 = 4;
+		step();
+		check(y, 14);
+		check(z, 3);
+	}
+};
+
+PHYSIM_RUN(ExprTest)
@@ -0,0 +1,104 @@
+/*
+ * Periodic steady-state fast-forward test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Counter: public PeriodicModel {
+public:
+	OutputPort<int> y;
+	int count;
+
+	Counter(string name, duration_t period, int modulo, ComposedModel *parent):
+		PeriodicModel(name, period, parent),
+		y(this, "y"),
+		count(0),
+		m(modulo),
+		s(this, "s", 0)
+	{ }
+protected:
+
+	void init() override { y = *s; }
+	void update(date_t at) override { count++; *s = (*s + 1) % m; y = *s; }
+
+private:
+	int m;
+	State<int, 1> s;
+};
+
+class Adder: public PeriodicModel {
+public:
+	InputPort<int> x1, x2;
+	OutputPort<int> y;
+
+	Adder(string name, duration_t period, ComposedModel *parent):
+		PeriodicModel(name, period, parent),
+		x1(this, "x1"),
+		x2(this, "x2"),
+		y(this, "y")
+	{ }
+protected:
+
+	void init() override { y = 0; }
+	void update(date_t at) override { y = x1 + x2; }
+};
+
+class Network: public ComposedModel {
+public:
+	Counter c1, c2;
+	Adder add;
+
+	Network():
+		ComposedModel("network"),
+		c1("c1", 2, 3, this),
+		c2("c2", 3, 2, this),
+		add("add", 1, this)
+	{
+		connect(c1.y, add.x1);
+		connect(c2.y, add.x2);
+	}
+};
+
+class FastForwardTest: public ReactiveTest {
+public:
+	Counter c1, c2;
+	Adder add;
+	InputPort<int> y;
+
+	FastForwardTest():
+		ReactiveTest("fast-forward-test"),
+		c1("c1", 2, 3, this),
+		c2("c2", 3, 2, this),
+		add("add", 1, this),
+		y(this, "y")
+	{
+		connect(c1.y, add.x1);
+		connect(c2.y, add.x2);
+		connect(add.y, y);
+	}
+
+	void test() override {
+		sim().stop();
+		sim().setFastForward(true);
+		sim().start();
+
+		// compare with a simulation of the same network without fast-forward
+		Network n;
+		Simulation ref(n);
+		for(auto d: { 1, 7, 36, 1001 }) {
+			sim().run(d - sim().date());
+			ref.run(d - ref.date());
+			check(sim().date() == ref.date(), "dates differ");
+			check(y, n.add.y.data()[0]);
+			check(n.c1.count == (d - 1) / 2, "reference simulation wrong");
+			if(d >= 36) {
+				check(sim().horizon() != 0, "steady state not detected");
+				check(c1.count < n.c1.count, "simulation not fast-forwarded");
+			}
+		}
+	}
+};
+
+PHYSIM_RUN(FastForwardTest)
@@ -0,0 +1,112 @@
+/*
+ * Reactive chain fusion test
+ */
+
+#include <sstream>
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Gen: public PeriodicModel {
+public:
+	OutputPort<int> y;
+
+	Gen(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		y(this, "y"),
+		k(0)
+	{ }
+protected:
+	void update(date_t at) override { y = ++k; }
+private:
+	int k;
+};
+
+class Neg: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Neg(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = -x; }
+};
+
+class Add: public ReactiveModel {
+public:
+	InputPort<int> a, b;
+	OutputPort<int> y;
+
+	Add(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		a(this, "a"),
+		b(this, "b"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = a + b; }
+};
+
+class FuseTest: public ReactiveTest {
+public:
+	Gen g;
+	Neg n1, n2, n3;
+	Add a;
+	InputPort<int> z, y;
+
+	FuseTest():
+		ReactiveTest("fuse-test"),
+		g("gen", this),
+		n1("n1", this),
+		n2("n2", this),
+		n3("n3", this),
+		a("add", this),
+		z(this, "z"),
+		y(this, "y")
+	{
+		connect(g.y, n1.x);
+		connect(n1.y, n2.x);
+		connect(n2.y, n3.x);
+		connect(n3.y, a.a);
+		connect(g.y, a.b);
+		connect(n3.y, z);
+		connect(a.y, y);
+	}
+
+	void test() override {
+
+		// the chain stops before the stage with two producers
+		check(sim().chains().size() == 1, "bad chain count");
+		if(sim().chains().size() == 1) {
+			const auto& c = sim().chains()[0];
+			check(c.size() == 3 && c[0] == &n1 && c[1] == &n2 && c[2] == &n3, "bad fused chain");
+		}
+
+		// the fused chain is traced at start
+		ostringstream text;
+		sim().stop();
+		sim().setTracing(true);
+		auto old = cerr.rdbuf(text.rdbuf());
+		sim().start();
+		step();
+		cerr.rdbuf(old);
+		sim().setTracing(false);
+#		ifndef PHYSIM_NO_TRACE
+			check(text.str().find("TRACE: fused chain fuse-test.n1 -> fuse-test.n2 -> fuse-test.n3\n") != string::npos,
+				"fused chain not traced");
+#		endif
+
+		// the fused chain computes the same values
+		for(int k = 1; k < 5; k++) {
+			step();
+			check(z, -k);
+			check(y, 0);
+		}
+	}
+};
+
+PHYSIM_RUN(FuseTest)
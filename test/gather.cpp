@@ -0,0 +1,59 @@
+/*
+ * Port gather test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Sink: public ReactiveModel {
+public:
+	InputPort<int, 3> x;
+	InputPort<float> y;
+	InputPort<string> z;
+
+	Sink(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y"),
+		z(this, "z")
+	{ }
+};
+
+class GatherTest: public ReactiveTest {
+public:
+	Sink s;
+	OutputPort<int, 3> x;
+	OutputPort<float> y;
+	OutputPort<string> z;
+
+	GatherTest():
+		ReactiveTest("gather-test"),
+		s("sink", this),
+		x(this, "x"),
+		y(this, "y"),
+		z(this, "z")
+	{
+		connect(x, s.x);
+		connect(y, s.y);
+		connect(z, s.z);
+	}
+
+	void test() override {
+		x.assign({ 1, 2, 3 });
+		y = 1.5;
+		z = "ok";
+		step();
+
+		double d[5];
+		check(s.x.gather(d) == 3 && d[0] == 1 && d[2] == 3, "bad gathered values");
+		check(s.x.gather(d, 1, 5) == 2 && d[0] == 2, "bad gathered range");
+
+		float f[5];
+		vector<AbstractPort *> ps = { &s.x, &s.z, &s.y };
+		check(AbstractPort::gather(ps, f) == 5, "bad gathered count");
+		check(f[0] == 1 && f[2] == 3 && f[3] == 0 && f[4] == 1.5, "bad gathered ports");
+	}
+};
+
+PHYSIM_RUN(GatherTest)
@@ -0,0 +1,90 @@
+/*
+ * Model and port index test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Gain: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+	Parameter<int, 1> k;
+
+	Gain(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y"),
+		k(this, "k", 2)
+	{ }
+protected:
+	void update() override { y = *k * x; }
+};
+
+class IndexTest: public ReactiveTest {
+public:
+	Gain g1, g2;
+	OutputPort<int> x;
+	InputPort<int> y;
+
+	IndexTest():
+		ReactiveTest("index-test"),
+		g1("g1", this),
+		g2("g2", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, g1.x);
+		connect(g1.y, g2.x);
+		connect(g2.y, y);
+	}
+
+	Gain *spawn(string name) {
+		auto g = sim().create<Gain>(name, this);
+		connect(g2.y, g->x);
+		sim().activate(*g);
+		return g;
+	}
+
+	void test() override {
+		check(sim().models().size() == 3, "bad model count");
+		check(sim().ports().size() == 6, "bad port count");
+		check(sim().values().size() == 2, "bad value count");
+		for(size_t i = 0; i < sim().models().size(); i++)
+			check(sim().model(i)->id() == int(i), "bad model ID");
+		for(size_t i = 0; i < sim().ports().size(); i++)
+			check(sim().port(i)->id() == int(i), "bad port ID");
+		check(sim().findModel("index-test.g2") == &g2, "model not found");
+		check(sim().findPort("index-test.g1.y") == &g1.y, "port not found");
+		check(sim().findValue("index-test.g2.k") == &g2.k, "value not found");
+		check(sim().findPort("index-test.g3.y") == nullptr, "unknown port found");
+		x = 3;
+		step();
+		check(y, 12);
+
+		// the IDs of a retired model are given to the next activated one
+		auto g3 = spawn("g3");
+		auto id = g3->id(), xid = g3->x.id(), kid = g3->k.id();
+		check(sim().findPort("index-test.g3.y") == &g3->y, "activated port not found");
+		x = 4;
+		step();
+		check(y, 16);
+		sim().retire(*g3);
+		step();
+		check(sim().findModel("index-test.g3") == nullptr, "retired model found");
+		auto g4 = spawn("g4");
+		check(sim().models().size() == 4, "model slot not reused");
+		check(sim().ports().size() == 8, "port slot not reused");
+		check(sim().values().size() == 3, "value slot not reused");
+		check(g4->id() == id && sim().model(id) == g4, "model ID not reused");
+		check(g4->x.id() == xid && sim().port(xid) == &g4->x, "port ID not reused");
+		check(g4->k.id() == kid && sim().value(kid) == &g4->k, "value ID not reused");
+		check(sim().findPort("index-test.g4.y") == &g4->y, "reused port not found");
+		x = 5;
+		step();
+		check(y, 20);
+	}
+};
+
+PHYSIM_RUN(IndexTest)
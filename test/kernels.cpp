@@ -0,0 +1,107 @@
+/*
+ * Aligned array port and kernel test
+ */
+
+#include <physim.h>
+#include <physim/kernels.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Stats: public ReactiveModel {
+public:
+	InputPort<double, 20> x;
+	OutputPort<double, 4> y;
+	OutputPort<double, 20> z;
+	int touches;
+
+	Stats(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y"),
+		z(this, "z"),
+		touches(0)
+	{ }
+protected:
+
+	void propagate(const AbstractPort& port) override {
+		touches++;
+		ReactiveModel::propagate(port);
+	}
+
+	void update() override {
+		y.assign({ sum(x), dot(x, x), minimum(x), maximum(x) });
+		scale(2., x, z);
+		axpy(-1., x, z);
+	}
+};
+
+class KernelsTest: public ReactiveTest {
+public:
+	Stats s;
+	OutputPort<double, 20> x;
+	InputPort<double, 4> y;
+	InputPort<double, 20> z;
+
+	KernelsTest():
+		ReactiveTest("kernels-test"),
+		s("stats", this),
+		x(this, "x"),
+		y(this, "y"),
+		z(this, "z")
+	{
+		connect(x, s.x);
+		connect(s.y, y);
+		connect(s.z, z);
+	}
+
+	void test() override {
+		check(reinterpret_cast<uintptr_t>(x.data()) % cache_line == 0, "array port not aligned");
+		check(reinterpret_cast<uintptr_t>(s.y.data()) % cache_line == 0, "array port not aligned");
+
+		s.touches = 0;
+		{
+			auto v = x.span();
+			for(int i = 0; i < v.size(); i++)
+				v[i] = i - 5;
+		}
+		step();
+		check(s.touches == 1, "span touched several times");
+		check(y, 90., 0);
+		check(y, 1070., 1);
+		check(y, -5., 2);
+		check(y, 14., 3);
+		for(int i = 0; i < 20; i++)
+			check(z, double(i - 5), i);
+
+		scale(-1., x);
+		step();
+		check(s.touches == 2, "scale touched several times");
+		check(y, -90., 0);
+		check(y, -14., 2);
+		check(y, 5., 3);
+		double t = 0;
+		for(auto v: z)
+			t += v;
+		check(t == -90., "bad scaled sum");
+
+		scale(1., x);
+		step();
+		check(s.touches == 2, "unchanged span touched");
+
+		int fired = 0;
+		auto w = x.watch(rises_above(40.), [&fired](date_t, const double&) { fired++; });
+		scale(10., x);
+		step();
+		check(fired == 1, "span write not watched");
+		check(y, -900., 0);
+		x.unwatch(w);
+
+		x.setFilter([](const double& o, double& v) { return v >= 0; });
+		scale(-1., x);
+		step();
+		check(s.touches == 4, "filtered span touched several times");
+		check(y, 1200., 0);
+	}
+};
+
+PHYSIM_RUN(KernelsTest)
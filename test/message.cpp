@@ -0,0 +1,91 @@
+/*
+ * Message port test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Job {
+public:
+	Job(int id_, int cost_): id(id_), cost(cost_) { live++; }
+	Job(const Job& j): id(j.id), cost(j.cost) { live++; }
+	~Job() { live--; }
+	int id, cost;
+	static int live;
+};
+int Job::live = 0;
+
+class Server: public ReactiveModel {
+public:
+	MessageInputPort<Job> jobs;
+	MessageOutputPort<Job> done;
+	OutputPort<int> load;
+	int updates;
+
+	Server(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		jobs(this, "jobs"),
+		done(this, "done"),
+		load(this, "load"),
+		updates(0)
+	{ }
+protected:
+
+	void update() override {
+		updates++;
+		int l = 0;
+		for(const auto& j: jobs) {
+			l += j.cost;
+			if(j.cost > 1)
+				done.send(j.id, j.cost - 1);
+		}
+		load = l;
+	}
+};
+
+class MessageTest: public ReactiveTest {
+public:
+	Server s1, s2, s3;
+	MessageOutputPort<Job> jobs;
+	InputPort<int> l1, l2, l3;
+
+	MessageTest():
+		ReactiveTest("message-test"),
+		s1("s1", this),
+		s2("s2", this),
+		s3("s3", this),
+		jobs(this, "jobs"),
+		l1(this, "l1"),
+		l2(this, "l2"),
+		l3(this, "l3")
+	{
+		connect(jobs, s1.jobs);
+		connect(jobs, s2.jobs);
+		connect(s1.done, s3.jobs);
+		connect(s1.load, l1);
+		connect(s2.load, l2);
+		connect(s3.load, l3);
+	}
+
+	void test() override {
+		jobs.send(1, 3);
+		jobs.send(2, 1);
+		jobs.send(Job(3, 2));
+		step();
+		check(l1, 6);
+		check(l2, 6);
+		check(l3, 3);
+		check(s1.updates == 1 && s2.updates == 1, "batch not drained at once");
+		check(s1.jobs.empty() && s3.jobs.empty(), "batch not released");
+		check(Job::live == 0, "messages leaked");
+
+		jobs.send(4, 1);
+		step();
+		check(l1, 1);
+		check(s3.updates == 1, "empty batch sent");
+		check(Job::live == 0, "messages leaked");
+	}
+};
+
+PHYSIM_RUN(MessageTest)
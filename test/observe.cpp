@@ -0,0 +1,49 @@
+/*
+ * Output port observer test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Recorder: public OutputPort<int, 2>::Observer {
+public:
+	Recorder(): count(0), last{0, 0} { }
+	void observe(const int *x) override {
+		count++;
+		last[0] = x[0];
+		last[1] = x[1];
+	}
+	int count;
+	int last[2];
+};
+
+class ObserveTest: public ReactiveTest {
+public:
+	OutputPort<int, 2> x;
+	Recorder r;
+
+	ObserveTest():
+		ReactiveTest("observe-test"),
+		x(this, "x")
+	{ }
+
+	void test() override {
+		x.observe(r);
+		x.assign({ 1, 2 });
+		step();
+		check(r.count == 1, "change not observed once");
+		check(r.last[0] == 1 && r.last[1] == 2, "bad observed values");
+
+		x.assign({ 1, 2 });
+		step();
+		check(r.count == 1, "unchanged port observed");
+
+		x.unobserve(r);
+		x[0] = 3;
+		step();
+		check(r.count == 1, "removed observer called");
+	}
+};
+
+PHYSIM_RUN(ObserveTest)
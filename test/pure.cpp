@@ -0,0 +1,69 @@
+/*
+ * Pure model test
+ */
+
+#include <physim.h>
+#include <physim/pure.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Poly: public PureModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+	int count;
+
+	Poly(string name, ComposedModel *parent):
+		PureModel(name, parent, 2),
+		x(this, "x"),
+		y(this, "y"),
+		count(0)
+	{
+		memoize(x);
+		memoize(y);
+	}
+protected:
+
+	void compute() override {
+		count++;
+		y = x * x + 1;
+	}
+};
+
+class PureTest: public ReactiveTest {
+public:
+	Poly p;
+	OutputPort<int> x;
+	InputPort<int> y;
+
+	PureTest():
+		ReactiveTest("pure-test"),
+		p("poly", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, p.x);
+		connect(p.y, y);
+	}
+
+	void test() override {
+		x = 2;
+		step();
+		check(y, 5);
+		x = 3;
+		step();
+		check(y, 10);
+		x = 2;
+		step();
+		check(y, 5);
+		check(p.count == 2, "compute() called on a cache hit");
+		x = 4;
+		step();
+		x = 3;
+		step();
+		check(y, 10);
+		check(p.hits() == 1 && p.misses() == 4, "bad hit/miss counters");
+	}
+};
+
+PHYSIM_RUN(PureTest)
@@ -0,0 +1,69 @@
+/*
+ * Port relinking test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Twice: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> twox;
+
+	Twice(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		twox(this, "twox")
+	{ }
+protected:
+
+	void update() override {
+		twox = x * 2;
+	}
+};
+
+class RelinkTest: public ReactiveTest {
+public:
+	Twice t1, t2, t3;
+	OutputPort<int> a, b;
+	InputPort<int> y;
+
+	RelinkTest():
+		ReactiveTest("relink-test"),
+		t1("t1", this),
+		t2("t2", this),
+		t3("t3", this),
+		a(this, "a"),
+		b(this, "b"),
+		y(this, "y")
+	{
+		connect(a, t1.x);
+		connect(a, t2.x);
+		connect(b, t3.x);
+		connect(t1.twox, y);
+	}
+
+	void test() override {
+		a = 1;
+		b = 10;
+		step();
+		check(y, 2);
+
+		t1.x.reconnect(b);
+		step();
+		check(y, 20);
+
+		a = 2;
+		step();
+		check(y, 20);
+		check(*t2.twox.data() == 4, "t2 lost its link");
+
+		b = 11;
+		step();
+		check(y, 22);
+		check(*t3.twox.data() == 22, "t3 lost its link");
+	}
+};
+
+PHYSIM_RUN(RelinkTest)
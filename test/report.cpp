@@ -0,0 +1,43 @@
+/*
+ * Report of values set before the report starts
+ */
+
+#include <sstream>
+#include <physim.h>
+#include <physim/std.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Source: public ReactiveModel {
+public:
+	OutputPort<int> y;
+
+	Source(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		y(this, "y")
+	{ }
+protected:
+	void start() override { y = 5; }
+};
+
+class ReportTest: public ReactiveTest {
+public:
+	Source s;
+	ostringstream out;
+	Report r;
+
+	ReportTest():
+		ReactiveTest("report-test"),
+		s("source", this),
+		r("report", this, out)
+	{
+		r.add(s.y);
+	}
+
+	void test() override {
+		step();
+		check(out.str().find("\n0\t5\n") != string::npos, "value set before start not reported");
+	}
+};
+
+PHYSIM_RUN(ReportTest)
@@ -0,0 +1,73 @@
+/*
+ * Shared payload port test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Cloud: public ReactiveModel {
+public:
+	InputPort<Shared<int>> x;
+	OutputPort<int> y;
+	Shared<int> last;
+
+	Cloud(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+
+	void update() override {
+		last = *x;
+		int s = 0;
+		for(auto v: last)
+			s += v;
+		y = s;
+	}
+};
+
+class SharedTest: public ReactiveTest {
+public:
+	Cloud c;
+	OutputPort<Shared<int>> x;
+	InputPort<int> y;
+
+	SharedTest():
+		ReactiveTest("shared-test"),
+		c("cloud", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, c.x);
+		connect(c.y, y);
+	}
+
+	void test() override {
+		Shared<int> s(1000, 1);
+		auto p = s.data();
+		x = std::move(s);
+		check(s.empty(), "payload not moved");
+		step();
+		check(y, 1000);
+		check(c.last.data() == p, "payload copied");
+		check(c.last.count() == 2, "bad reference count");
+
+		Shared<int> t = c.last;
+		t.edit()[0] = 1001;
+		check(t.data() != p, "shared payload edited in place");
+		check(c.last[0] == 1, "consumer sees the edition");
+		x = t;
+		step();
+		check(y, 2000);
+		check(c.last.data() == t.data(), "payload copied");
+
+		x = t;
+		step();
+		check(y, 2000);
+		check(x.data()[0].count() == 3, "bad reference count");
+	}
+};
+
+PHYSIM_RUN(SharedTest)
@@ -0,0 +1,77 @@
+/*
+ * Static dispatch models test
+ */
+
+#include <physim.h>
+#include <physim/static.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Square: public StaticReactiveModel<Square> {
+	friend class StaticReactiveModel<Square>;
+public:
+	InputPort<int> x;
+	OutputPort<int> x2;
+
+	Square(string name, ComposedModel *parent):
+		StaticReactiveModel<Square>(name, parent),
+		x(this, "x"),
+		x2(this, "x2")
+	{ }
+
+private:
+	inline void compute() { x2 = x * x; }
+};
+
+class Accu: public StaticPeriodicModel<Accu> {
+	friend class StaticPeriodicModel<Accu>;
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Accu(string name, ComposedModel *parent):
+		StaticPeriodicModel<Accu>(name, 1, parent),
+		x(this, "x"),
+		y(this, "y"),
+		s(0)
+	{ }
+
+private:
+	inline void compute(date_t date) { s = s + x; y = s; }
+	inline void publishOutputs() { publishPorts(y); }
+	int s;
+};
+
+class StaticTest: public ReactiveTest {
+public:
+	Square s;
+	Accu a;
+	OutputPort<int> x;
+	InputPort<int> y;
+
+	StaticTest():
+		ReactiveTest("static-test"),
+		s("square", this),
+		a("accu", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, s.x);
+		connect(s.x2, a.x);
+		connect(a.y, y);
+	}
+
+	void test() override {
+		x = 2;
+		step();
+		step();
+		check(y, 4);
+		x = 3;
+		step();
+		check(y, 8);
+		step();
+		check(y, 17);
+	}
+};
+
+PHYSIM_RUN(StaticTest)
@@ -0,0 +1,125 @@
+/*
+ * Steady periodic model test
+ */
+
+#include <physim.h>
+#include <physim/static.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Integ: public PeriodicModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+	int count;
+
+	Integ(string name, duration_t period, ComposedModel *parent):
+		PeriodicModel(name, period, parent),
+		x(this, "x"),
+		y(this, "y"),
+		count(0),
+		s(0)
+	{ }
+protected:
+
+	void init() override {
+		y = s;
+	}
+
+	void update(date_t at) override {
+		count++;
+		s = s + x;
+		y = s;
+		if(x == 0)
+			steady();
+	}
+
+private:
+	int s;
+};
+
+class StaticInteg: public StaticPeriodicModel<StaticInteg> {
+	friend class StaticPeriodicModel<StaticInteg>;
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+	int count;
+
+	StaticInteg(string name, duration_t period, ComposedModel *parent):
+		StaticPeriodicModel<StaticInteg>(name, period, parent),
+		x(this, "x"),
+		y(this, "y"),
+		count(0),
+		s(0)
+	{ }
+protected:
+
+	void init() override {
+		y = s;
+	}
+
+private:
+	inline void compute(date_t at) {
+		count++;
+		s = s + x;
+		y = s;
+		if(x == 0)
+			steady();
+	}
+
+	int s;
+};
+
+class SteadyTest: public ReactiveTest {
+public:
+	Integ i;
+	StaticInteg si;
+	OutputPort<int> x;
+	InputPort<int> y, sy;
+
+	SteadyTest():
+		ReactiveTest("steady-test"),
+		i("integ", 2, this),
+		si("static-integ", 2, this),
+		x(this, "x"),
+		y(this, "y"),
+		sy(this, "sy")
+	{
+		connect(x, i.x);
+		connect(i.y, y);
+		connect(x, si.x);
+		connect(si.y, sy);
+	}
+
+	void init() override {
+		ReactiveTest::init();
+		x = 1;
+	}
+
+	void test() override {
+		for(int j = 0; j < 5; j++)
+			step();
+		check(y, 2);
+		check(sy, 2);
+		x = 0;
+		for(int j = 0; j < 6; j++)
+			step();
+		check(i.isParked(), "model not parked");
+		check(i.count == 3, "parked model updated");
+		check(si.isParked(), "static model not parked");
+		check(si.count == 3, "parked static model updated");
+		x = 3;
+		step();
+		check(!i.isParked(), "model not resumed");
+		check(!si.isParked(), "static model not resumed");
+		check(y, 2);
+		check(sy, 2);
+		step();
+		check(y, 5);
+		check(sy, 5);
+		check(i.count == 4, "model not resumed on its period");
+		check(si.count == 4, "static model not resumed on its period");
+	}
+};
+
+PHYSIM_RUN(SteadyTest)
@@ -0,0 +1,120 @@
+/*
+ * Binary trace recorder test
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Hold: public PeriodicModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Hold(string name, ComposedModel *parent):
+		PeriodicModel(name, 1, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void init() override { y = 0; }
+	void update(date_t at) override { y = 2 * x; steady(); }
+};
+
+class Neg: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Neg(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = -x; }
+};
+
+class TraceTest: public ReactiveTest {
+public:
+	Hold h;
+	Neg n;
+	OutputPort<int> x;
+	InputPort<int> y;
+
+	TraceTest():
+		ReactiveTest("trace-test"),
+		h("hold", this),
+		n("neg", this),
+		x(this, "x"),
+		y(this, "y")
+	{
+		connect(x, h.x);
+		connect(h.y, n.x);
+		connect(n.y, y);
+		n.y.watch([](const int& o, const int& v) { return v < -10; });
+	}
+
+	void test() override {
+		auto tmp = getenv("TMPDIR");
+		string path = string(tmp != nullptr ? tmp : "/tmp") + "/physim-trace-XXXXXX";
+		auto fd = mkstemp(&path[0]);
+		check(fd >= 0, "cannot create a temporary file");
+		if(fd < 0)
+			return;
+		close(fd);
+
+		// record the scenario
+		ostringstream text;
+		{
+			TraceRecorder rec(path, 8);
+			check(rec.isOpen(), "cannot open the trace file");
+			auto old = cerr.rdbuf(text.rdbuf());
+			sim().setRecorder(&rec);
+			x = 0;
+			for(int k = 0; k < 4; k++) {
+				step();
+				cerr.rdbuf(old);
+				check(y, 0);
+				cerr.rdbuf(text.rdbuf());
+			}
+			x = 3;
+			step();
+			step();
+			cerr.rdbuf(old);
+			check(y, -6);
+			cerr.rdbuf(text.rdbuf());
+			x = 6;
+			step();
+			step();
+			cerr.rdbuf(old);
+			check(y, -12);
+			check(sim().isStopped(), "watch did not stop the simulation");
+			sim().setRecorder(nullptr);
+			sim().setTracing(false);
+		}
+		check(text.str() == "", "text trace displayed while recording");
+
+		// decode it
+		ifstream in(path, ios::binary);
+		ostringstream decoded;
+		check(TraceRecorder::decode(in, decoded), "truncated trace");
+		in.close();
+		remove(path.c_str());
+		auto s = decoded.str();
+#		ifndef PHYSIM_NO_TRACE
+			check(s.find(": port trace-test.neg.y receives -6\n") != string::npos, "write not recorded");
+			check(s.find(": updating trace-test.neg\n") != string::npos, "update not recorded");
+			check(s.find(": parking trace-test.hold\n") != string::npos, "parking not recorded");
+			check(s.find(": resuming trace-test.hold at ") != string::npos, "resuming not recorded");
+			check(s.find(": watch on trace-test.neg.y stops the simulation\n") != string::npos, "watch not recorded");
+#		endif
+	}
+};
+
+PHYSIM_RUN(TraceTest)
@@ -0,0 +1,96 @@
+/*
+ * Write transaction test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Clamp: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> y;
+
+	Clamp(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override {
+		y = x;
+		if(x > 10)
+			y = 10;
+		y = 2 * *y;
+	}
+};
+
+class Probe: public ReactiveModel {
+public:
+	InputPort<int> x;
+	int touches;
+
+	Probe(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		touches(0)
+	{ }
+protected:
+	void propagate(const AbstractPort& port) override {
+		touches++;
+		ReactiveModel::propagate(port);
+	}
+	void update() override { }
+};
+
+class TransactionTest: public ReactiveTest {
+public:
+	Clamp c;
+	Probe p;
+	OutputPort<int> x;
+
+	TransactionTest():
+		ReactiveTest("transaction-test"),
+		c("clamp", this),
+		p("probe", this),
+		x(this, "x")
+	{
+		connect(x, c.x);
+		connect(c.y, p.x);
+	}
+
+	void test() override {
+		p.touches = 0;
+		x = 3;
+		step();
+		check(p.x, 6);
+		check(p.touches == 1, "intermediate writes propagated");
+		x = 20;
+		step();
+		check(p.x, 20);
+		check(p.touches == 2, "intermediate writes propagated");
+		x = 30;
+		step();
+		check(p.touches == 2, "unchanged output propagated");
+
+		int fired = 0;
+		c.y.watch(rises_above(30), [&fired](date_t, const int&) { fired++; });
+		x = 16;
+		step();
+		check(p.x, 20);
+		check(fired == 0, "watch fired on an intermediate value");
+		x = 40;
+		step();
+		check(fired == 0, "watch fired on an intermediate value");
+		x = 8;
+		step();
+		check(p.x, 16);
+		c.y.watch(rises_above(17), [&fired](date_t, const int&) { fired++; });
+		x = 9;
+		step();
+		check(p.x, 18);
+		check(fired == 1, "watch not fired on the final value");
+	}
+};
+
+PHYSIM_RUN(TransactionTest)
@@ -0,0 +1,148 @@
+/*
+ * Wake coalescing test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Split: public ReactiveModel {
+public:
+	InputPort<int> x;
+	OutputPort<int> a, b, c;
+
+	Split(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		a(this, "a"),
+		b(this, "b"),
+		c(this, "c")
+	{ }
+protected:
+	void update() override { a = x; b = x + 1; c = x + 2; }
+};
+
+class Join: public ReactiveModel {
+public:
+	InputPort<int> a, b, c;
+	OutputPort<int> y;
+	int wakes, updates;
+	vector<const AbstractPort *> woken;
+
+	Join(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		a(this, "a"),
+		b(this, "b"),
+		c(this, "c"),
+		y(this, "y"),
+		wakes(0),
+		updates(0)
+	{ }
+protected:
+	void propagate(const AbstractPort& port) override {
+		wakes++;
+		woken.push_back(&port);
+		ReactiveModel::propagate(port);
+	}
+	void update() override { updates++; y = a + b + c; }
+};
+
+class Fan: public ReactiveModel {
+public:
+	static const int size = 70;
+	InputPort<int> x;
+	vector<OutputPort<int> *> ys;
+
+	Fan(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x")
+	{
+		for(int i = 0; i < size; i++)
+			ys.push_back(new OutputPort<int>(this, "y" + to_string(i)));
+	}
+	~Fan() { for(auto y: ys) delete y; }
+protected:
+	void update() override { for(int i = 0; i < size; i++) *ys[i] = x + i; }
+};
+
+class Wide: public ReactiveModel {
+public:
+	vector<InputPort<int> *> xs;
+	OutputPort<int> y;
+	int wakes, updates;
+
+	Wide(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		y(this, "y"),
+		wakes(0),
+		updates(0)
+	{
+		for(int i = 0; i < Fan::size; i++)
+			xs.push_back(new InputPort<int>(this, "x" + to_string(i)));
+	}
+	~Wide() { for(auto x: xs) delete x; }
+protected:
+	void propagate(const AbstractPort& port) override {
+		wakes++;
+		ReactiveModel::propagate(port);
+	}
+	void update() override {
+		updates++;
+		int s = 0;
+		for(auto x: xs)
+			s += *x;
+		y = s;
+	}
+};
+
+class WakeTest: public ReactiveTest {
+public:
+	Split s;
+	Join j;
+	Fan f;
+	Wide w;
+	OutputPort<int> x;
+	InputPort<int> y, z;
+
+	WakeTest():
+		ReactiveTest("wake-test"),
+		s("split", this),
+		j("join", this),
+		f("fan", this),
+		w("wide", this),
+		x(this, "x"),
+		y(this, "y"),
+		z(this, "z")
+	{
+		connect(x, s.x);
+		connect(s.a, j.a);
+		connect(s.b, j.b);
+		connect(s.c, j.c);
+		connect(j.y, y);
+		connect(x, f.x);
+		for(int i = 0; i < Fan::size; i++)
+			connect(*f.ys[i], *w.xs[i]);
+		connect(w.y, z);
+	}
+
+	void test() override {
+		for(int i = 1; i <= 5; i++) {
+			j.wakes = 0;
+			j.updates = 0;
+			j.woken.clear();
+			w.wakes = 0;
+			w.updates = 0;
+			x = i;
+			step();
+			check(y, 3 * i + 3);
+			check(j.updates == 1, "join updated several times");
+			check(j.wakes == 3, "join not notified once per port");
+			check(find(j.woken.begin(), j.woken.end(), &j.c) != j.woken.end(), "join not notified for c");
+			check(z, Fan::size * i + Fan::size * (Fan::size - 1) / 2);
+			check(w.updates == 1, "wide updated several times");
+			check(w.wakes == Fan::size, "wide not notified once per port");
+		}
+	}
+};
+
+PHYSIM_RUN(WakeTest)
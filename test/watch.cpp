@@ -0,0 +1,91 @@
+/*
+ * Port watch test
+ */
+
+#include <physim.h>
+#include <physim/test.h>
+using namespace physim;
+
+class Tank: public PeriodicModel {
+public:
+	OutputPort<double> level;
+
+	Tank(string name, ComposedModel *parent):
+		PeriodicModel(name, 2, parent),
+		level(this, "level"),
+		l(0)
+	{ }
+protected:
+
+	void init() override { l = 0; level = l; }
+	void update(date_t at) override { l = l < 1 ? l + .1 : 0; level = l; }
+
+private:
+	double l;
+};
+
+class Gauge: public ReactiveModel {
+public:
+	InputPort<double> x;
+	OutputPort<double> y;
+
+	Gauge(string name, ComposedModel *parent):
+		ReactiveModel(name, parent),
+		x(this, "x"),
+		y(this, "y")
+	{ }
+protected:
+	void update() override { y = x * 10; }
+};
+
+class WatchTest: public ReactiveTest {
+public:
+	Tank t;
+	Gauge g;
+	InputPort<double> level, y;
+
+	WatchTest():
+		ReactiveTest("watch-test"),
+		t("tank", this),
+		g("gauge", this),
+		level(this, "level"),
+		y(this, "y")
+	{
+		connect(t.level, level);
+		connect(t.level, g.x);
+		connect(g.y, y);
+	}
+
+	void test() override {
+
+		// one-shot and permanent callbacks
+		vector<date_t> dates;
+		int id = 0;
+		id = t.level.watch(rises_above(.25),
+			[&](date_t d, const double& x) { dates.push_back(d); t.level.unwatch(id); });
+		t.level.watch(rises_above(.45),
+			[&](date_t d, const double& x) { dates.push_back(d); });
+		for(int i = 0; i < 11; i++)
+			step();
+		check(level, .5);
+		check(dates.size() == 2, "bad callback count");
+		check(dates.size() == 2 && dates[0] == 6 && dates[1] == 10, "bad callback dates");
+
+		// pause on falling edge
+		t.level.watch(falls_below(.5), PAUSE);
+		sim().run(100);
+		check(sim().date() == 25, "bad pause date");
+		check(level, 0.);
+
+		// stop on threshold at the end of the date
+		t.level.watch(above(.35), STOP);
+		for(int i = 0; i < 100 && !sim().isStopped(); i++)
+			step();
+		check(sim().isStopped(), "simulation not stopped");
+		check(sim().date() == 33, "bad stop date");
+		checkApprox(level, .4);
+		checkApprox(y, 4.);
+	}
+};
+
+PHYSIM_RUN(WatchTest)